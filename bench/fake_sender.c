@@ -0,0 +1,110 @@
+#define _XOPEN_SOURCE 600
+#include "uart.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+
+/**
+ * Stand-in for the flight computer on a host box: opens a pseudo
+ * terminal, prints the slave path for lcd_app --uart and streams a
+ * synthetic attitude sweep into it. Framed packets carry this host's
+ * CLOCK_MONOTONIC as sender timestamp, so lcd_app --latency can measure
+ * sender-to-wire latency directly.
+ *
+ * Usage: fake_sender [--rate HZ] [--legacy]
+ */
+
+#define DEFAULT_RATE    50
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        { "rate",   required_argument, NULL, 'r' },
+        { "legacy", no_argument,       NULL, 'L' },
+        { "help",   no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int rate = DEFAULT_RATE;
+    int legacy = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "r:Lh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'r':
+            rate = atoi(optarg);
+            break;
+        case 'L':
+            legacy = 1;
+            break;
+        default:
+            printf("Usage: %s [--rate HZ] [--legacy]\n", argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (rate <= 0)
+        rate = DEFAULT_RATE;
+
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+
+    printf("%s\n", ptsname(fd));
+    fflush(stdout);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (uint16_t seq = 0; ; seq++) {
+        double t = now_us() / 1000000.0;
+        attitude_t a = {
+            .pitch = 60 * sin(t * 0.7),
+            .roll = 45 * sin(t * 0.3),
+            .yaw = fmod(t * 20.0, 360),
+            .seq = seq,
+        };
+
+        uint8_t buf[UART_FRAME_SIZE];
+        size_t n;
+
+        if (legacy) {
+            buf[0] = UART_START_BYTE;
+            memcpy(&buf[1], &a.pitch, 2);
+            memcpy(&buf[3], &a.roll, 2);
+            memcpy(&buf[5], &a.yaw, 2);
+            n = UART_PACKET_SIZE;
+        } else {
+            a.sender_us = now_us();
+            n = uart_frame_encode(buf, &a);
+        }
+
+        // Nobody on the slave side yet is not an error
+        if (write(fd, buf, n) < 0)
+            usleep(100000);
+
+        next.tv_nsec += 1000000000L / rate;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    return 0;
+}
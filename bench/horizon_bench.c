@@ -0,0 +1,162 @@
+#include "horizon.h"
+#include "trajectory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Host benchmark for the navball renderer. Links only horizon.c and the
+ * textures, no libgpiod/spidev, so it runs on any x86/ARM Linux box.
+ *
+ * Usage: horizon_bench [--roll] [--heading] [frames per trajectory]
+ *
+ * --roll replaces the trajectories with fixed attitudes at 0/30/60/90 deg
+ * on-screen roll, to compare texture layouts under perf stat
+ * (make bench-cache).
+ * --heading renders through draw_navball_heading() (roll as a U shift).
+ */
+
+#define DEFAULT_FRAMES  2000
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, int n, int pct)
+{
+    int i = (int)((int64_t)(n - 1) * pct / 100);
+    return sorted[i];
+}
+
+static void report(const char *name, uint64_t *samples, int n, int pixels)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += samples[i];
+
+    qsort(samples, n, sizeof(samples[0]), cmp_u64);
+
+    double mean = (double)sum / n;
+
+    printf("%-16s %10.0f ", name, mean);
+    if (pixels)
+        printf("%8.2f ", mean / pixels);
+    else
+        printf("%8s ", "");
+
+    printf("%10llu %10llu %10llu %10llu\n",
+           (unsigned long long)percentile(samples, n, 50),
+           (unsigned long long)percentile(samples, n, 90),
+           (unsigned long long)percentile(samples, n, 99),
+           (unsigned long long)samples[n - 1]);
+}
+
+static void bench_trig(uint64_t *samples, int n)
+{
+    volatile float sink = 0;
+
+    for (int i = 0; i < n; i++) {
+        float rad = (i % 1000) * 0.0137f - 6.0f;
+
+        uint64_t t0 = now_ns();
+        for (int k = 0; k < 100; k++)
+            sink += fsin(rad + k * 0.01f) + fcos(rad - k * 0.01f);
+        samples[i] = (now_ns() - t0) / 200;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const trajectory_t *set = trajectories;
+    int set_count = trajectory_count;
+
+    void (*draw)(float, float, float) = draw_navball;
+
+    while (argc > 1 && argv[1][0] == '-') {
+        if (strcmp(argv[1], "--roll") == 0) {
+            set = roll_trajectories;
+            set_count = roll_trajectory_count;
+        } else if (strcmp(argv[1], "--heading") == 0) {
+            draw = draw_navball_heading;
+        } else {
+            printf("Usage: %s [--roll] [--heading] [frames per trajectory]\n", argv[0]);
+            return 1;
+        }
+        argc--;
+        argv++;
+    }
+
+    int frames = argc > 1 ? atoi(argv[1]) : DEFAULT_FRAMES;
+    if (frames <= 0)
+        frames = DEFAULT_FRAMES;
+
+    uint64_t *samples = malloc(frames * sizeof(uint64_t));
+    if (!samples)
+        return 1;
+
+    horizon_init();
+    fb_clear(FB_COLOR(COLOR565_BLACK));
+
+    int pixels = horizon_navball_pixels();
+
+#if defined(HORIZON_TEXTURE_LINEAR)
+    const char *layout = "row-major";
+#else
+    const char *layout = "tiled";
+#endif
+
+    printf("navball pixels: %d, frames per trajectory: %d, texture: %s%s\n\n",
+           pixels, frames, layout, draw == draw_navball ? "" : ", heading mode");
+    printf("%-16s %10s %8s %10s %10s %10s %10s\n",
+           "draw_navball", "ns/frame", "ns/px", "p50", "p90", "p99", "max");
+
+    for (int t = 0; t < set_count; t++) {
+        float pitch, roll, yaw;
+
+        // Warm up caches and the branch predictor
+        for (int i = 0; i < 20; i++) {
+            set[t].attitude(i, &pitch, &roll, &yaw);
+            draw(pitch, roll, yaw);
+        }
+
+        for (int i = 0; i < frames; i++) {
+            set[t].attitude(i, &pitch, &roll, &yaw);
+
+            uint64_t t0 = now_ns();
+            draw(pitch, roll, yaw);
+            samples[i] = now_ns() - t0;
+        }
+
+        report(set[t].name, samples, frames, pixels);
+    }
+
+    printf("\n%-16s %10s %8s %10s %10s %10s %10s\n",
+           "other", "ns/call", "", "p50", "p90", "p99", "max");
+
+    for (int i = 0; i < frames; i++) {
+        uint64_t t0 = now_ns();
+        framebuffer_draw_circle(radius + 1, cx, cy, FB_COLOR(COLOR565_GREEN));
+        samples[i] = now_ns() - t0;
+    }
+    report("draw_circle", samples, frames, 0);
+
+    bench_trig(samples, frames);
+    report("fsin/fcos", samples, frames, 0);
+
+    fb_rect_t dirty;
+    horizon_take_dirty(&dirty);
+
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "horizon.h"
+#include "st7735s.h"
+#include "st7735s_backend.h"
+#include "trajectory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <getopt.h>
+
+/**
+ * Offline SPI bus model. Renders the benchmark trajectories, pushes every
+ * frame through st7735s.c on the sim backend and reports the modeled
+ * wire cost and the frame rate the panel link would sustain. Links no
+ * libgpiod/spidev, runs on any Linux box.
+ *
+ * Usage: spi_sim [--speed HZ] [--bufsiz N] [--syscall-ns N] [--dc-ns N]
+ *                [--pixel-bits 12|16|24] [frames per trajectory]
+ */
+
+#define DEFAULT_FRAMES  500
+
+typedef enum {
+    UPDATE_FULL,        // whole framebuffer every frame
+    UPDATE_RECT,        // dirty bounding box, changed frames only
+    UPDATE_DIFF,        // row diff against the panel shadow (lcd_app)
+} update_mode_t;
+
+static const char *mode_names[] = { "full", "rect", "diff" };
+
+static uint16_t *frames[2];
+
+static void push_frame(st7735s_t *lcd, update_mode_t mode,
+                       uint16_t *fb, const fb_rect_t *dirty, int changed)
+{
+    switch (mode) {
+    case UPDATE_FULL:
+        st7735s_push_framebuffer(lcd, fb, FB_WIDTH, FB_HEIGHT);
+        break;
+    case UPDATE_RECT:
+        if (changed)
+            st7735s_push_rect(lcd, fb, FB_WIDTH,
+                              dirty->x0, dirty->y0, dirty->x1, dirty->y1);
+        break;
+    case UPDATE_DIFF:
+        if (changed)
+            st7735s_push_framebuffer_diff(lcd, fb, dirty->y0, dirty->y1);
+        break;
+    }
+}
+
+static void run(st7735s_t *lcd, update_mode_t mode,
+                const trajectory_t *traj, int n)
+{
+    const st7735s_sim_counters_t *c = st7735s_sim_counters(lcd->backend);
+    st7735s_sim_counters_t start;
+    int cur = 0;
+
+    // Both buffers and the panel start out with the same first frame
+    float pitch, roll, yaw;
+    traj->attitude(0, &pitch, &roll, &yaw);
+    for (int i = 0; i < 2; i++) {
+        horizon_set_framebuffer(frames[i], NULL);
+        fb_clear(FB_COLOR(COLOR565_BLACK));
+        draw_navball(pitch, roll, yaw);
+        framebuffer_draw_circle(radius + 1, cx, cy, FB_COLOR(COLOR565_GREEN));
+    }
+    fb_rect_t dirty;
+    horizon_take_dirty(&dirty);
+    st7735s_push_framebuffer_diff(lcd, frames[0], 0, FB_HEIGHT - 1);
+
+    start = *c;
+    int pushed = 0;
+
+    for (int i = 1; i <= n; i++) {
+        int next = cur ^ 1;
+
+        horizon_set_framebuffer(frames[next], frames[cur]);
+        traj->attitude(i, &pitch, &roll, &yaw);
+        draw_navball(pitch, roll, yaw);
+        framebuffer_draw_circle(radius + 1, cx, cy, FB_COLOR(COLOR565_GREEN));
+
+        int changed = horizon_take_dirty(&dirty);
+        push_frame(lcd, mode, frames[next], &dirty, changed);
+
+        if (changed || mode == UPDATE_FULL)
+            pushed++;
+        if (changed)
+            cur = next;
+    }
+
+    uint64_t wire_ns = c->wire_ns - start.wire_ns;
+    double per_frame_us = wire_ns / 1000.0 / n;
+
+    printf("%-14s %-5s %6d %9.0f %7.1f %7.1f %7.1f %10.1f ",
+           traj->name, mode_names[mode], pushed,
+           (double)(c->bytes - start.bytes) / n,
+           (double)(c->ioctls - start.ioctls) / n,
+           (double)(c->dc_toggles - start.dc_toggles) / n,
+           (double)(c->pixel_bytes - start.pixel_bytes) * 100.0 /
+               ((c->bytes - start.bytes) ? (c->bytes - start.bytes) : 1),
+           per_frame_us);
+
+    if (wire_ns)
+        printf("%9.1f\n", 1000000.0 / per_frame_us);
+    else
+        printf("%9s\n", "idle");
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [--speed HZ] [--bufsiz N] [--syscall-ns N] [--dc-ns N]\n"
+           "       %*s [--pixel-bits 12|16|24] [frames per trajectory]\n",
+           prog, (int)strlen(prog), "");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        { "speed",      required_argument, NULL, 's' },
+        { "bufsiz",     required_argument, NULL, 'b' },
+        { "syscall-ns", required_argument, NULL, 'c' },
+        { "dc-ns",      required_argument, NULL, 'd' },
+        { "pixel-bits", required_argument, NULL, 'p' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    st7735s_sim_config_t cfg;
+    st7735s_sim_default_config(&cfg);
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:b:c:d:p:h", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 's': cfg.speed_hz = strtoul(optarg, NULL, 0); break;
+        case 'b': cfg.bufsiz = strtoul(optarg, NULL, 0); break;
+        case 'c': cfg.syscall_ns = strtoul(optarg, NULL, 0); break;
+        case 'd': cfg.dc_toggle_ns = strtoul(optarg, NULL, 0); break;
+        case 'p': cfg.pixel_bits = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    int n = optind < argc ? atoi(argv[optind]) : DEFAULT_FRAMES;
+    if (n <= 0)
+        n = DEFAULT_FRAMES;
+
+    for (int i = 0; i < 2; i++) {
+        frames[i] = malloc(FB_WIDTH * FB_HEIGHT * sizeof(uint16_t));
+        if (!frames[i])
+            return 1;
+    }
+
+    horizon_init();
+
+    printf("%u Hz, bufsiz %u, %u ns/ioctl, %u ns/DC, %d bits/pixel, "
+           "%d frames per trajectory\n\n",
+           cfg.speed_hz, cfg.bufsiz, cfg.syscall_ns, cfg.dc_toggle_ns,
+           cfg.pixel_bits, n);
+    printf("%-14s %-5s %6s %9s %7s %7s %7s %10s %9s\n",
+           "trajectory", "mode", "pushed", "bytes/f", "ioctl/f", "dc/f",
+           "pixel%", "us/frame", "fps");
+
+    for (int mode = UPDATE_FULL; mode <= UPDATE_DIFF; mode++) {
+        st7735s_t lcd;
+
+        if (st7735s_init(&lcd, st7735s_sim_open(&cfg))) {
+            printf("LCD init failed...\n");
+            return 1;
+        }
+
+        // Window grouping decisions follow the modeled bus
+        lcd.cost.syscall_ns = cfg.syscall_ns;
+        lcd.cost.dc_toggle_ns = cfg.dc_toggle_ns;
+
+        for (int t = 0; t < trajectory_count; t++)
+            run(&lcd, mode, &trajectories[t], n);
+
+        st7735s_close(&lcd);
+        printf("\n");
+    }
+
+    for (int i = 0; i < 2; i++)
+        free(frames[i]);
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "uart.h"
+#include "telemetry_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+
+/**
+ * Writes synthetic flight profiles as telemetry logs for
+ * lcd_app --replay, one packet per record as the UART would deliver it.
+ *
+ * Usage: telemetry_gen [--profile launch|docking|reentry] [--rate HZ]
+ *                      [--seconds N] [--legacy] OUT.log
+ */
+
+typedef struct {
+    const char *name;
+    void (*attitude)(double t, float *pitch, float *roll, float *yaw);
+} profile_t;
+
+// Vertical ascent, roll program, then gravity turn towards the horizon
+static void profile_launch(double t, float *pitch, float *roll, float *yaw)
+{
+    *pitch = t < 10 ? 90 : 90 - fmin((t - 10) * 1.5, 80);
+    *roll = t < 5 ? 0 : fmin((t - 5) * 9, 90);
+    *yaw = 90;
+}
+
+// Small slow corrections around a fixed attitude, RCS pulses
+static void profile_docking(double t, float *pitch, float *roll, float *yaw)
+{
+    *pitch = 2 * sin(t * 0.4) + 0.5 * sin(t * 3.1);
+    *roll = 3 * sin(t * 0.25);
+    *yaw = 180 + 1.5 * sin(t * 0.33);
+}
+
+// Uncontrolled tumble, fast rotation on all axes
+static void profile_reentry(double t, float *pitch, float *roll, float *yaw)
+{
+    *pitch = 80 * sin(t * 1.7);
+    *roll = fmod(t * 190, 360) - 180;
+    *yaw = fmod(t * 75, 360);
+}
+
+static const profile_t profiles[] = {
+    { "launch",  profile_launch },
+    { "docking", profile_docking },
+    { "reentry", profile_reentry },
+};
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [--profile launch|docking|reentry] [--rate HZ]\n"
+           "       %*s [--seconds N] [--legacy] OUT.log\n",
+           prog, (int)strlen(prog), "");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        { "profile", required_argument, NULL, 'p' },
+        { "rate",    required_argument, NULL, 'r' },
+        { "seconds", required_argument, NULL, 's' },
+        { "legacy",  no_argument,       NULL, 'L' },
+        { "help",    no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    const profile_t *profile = &profiles[0];
+    int rate = 50;
+    int seconds = 60;
+    int legacy = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:r:s:Lh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'p':
+            profile = NULL;
+            for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+                if (!strcmp(optarg, profiles[i].name))
+                    profile = &profiles[i];
+            if (!profile) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'r':
+            rate = atoi(optarg);
+            break;
+        case 's':
+            seconds = atoi(optarg);
+            break;
+        case 'L':
+            legacy = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc || rate <= 0 || seconds <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    telemetry_log_t log;
+    if (telemetry_log_create(&log, argv[optind], 0)) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    int packets = rate * seconds;
+
+    for (int i = 0; i < packets; i++) {
+        uint64_t t_us = (uint64_t)i * 1000000 / rate;
+        float pitch, roll, yaw;
+
+        profile->attitude(t_us / 1000000.0, &pitch, &roll, &yaw);
+
+        attitude_t a = {
+            .pitch = lrintf(pitch),
+            .roll = lrintf(roll),
+            .yaw = lrintf(yaw),
+            .seq = i,
+            .sender_us = t_us,
+        };
+
+        uint8_t buf[UART_FRAME_SIZE];
+        size_t n;
+
+        if (legacy) {
+            buf[0] = UART_START_BYTE;
+            memcpy(&buf[1], &a.pitch, 2);
+            memcpy(&buf[3], &a.roll, 2);
+            memcpy(&buf[5], &a.yaw, 2);
+            n = UART_PACKET_SIZE;
+        } else {
+            n = uart_frame_encode(buf, &a);
+        }
+
+        if (telemetry_log_write(&log, t_us, buf, n)) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    telemetry_log_close(&log);
+    printf("%s: %d packets, %s, %d s\n", argv[optind], packets,
+           profile->name, seconds);
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "trajectory.h"
+
+static void traj_static(int frame, float *pitch, float *roll, float *yaw)
+{
+    *pitch = 12.0f;
+    *roll = -8.0f;
+    *yaw = 95.0f;
+}
+
+static void traj_slow_roll(int frame, float *pitch, float *roll, float *yaw)
+{
+    *pitch = 5.0f;
+    *roll = frame * 0.5f;
+    *yaw = 90.0f;
+}
+
+static void traj_fast_tumble(int frame, float *pitch, float *roll, float *yaw)
+{
+    *pitch = frame * 7.0f;
+    *roll = frame * 11.0f;
+    *yaw = frame * 13.0f;
+}
+
+// Level turn: the ball only turns about its pole, draw_navball()'s Ry
+// roll_deg, and the heading scale scrolls
+static void traj_flat_turn(int frame, float *pitch, float *roll, float *yaw)
+{
+    *pitch = 5.0f;
+    *roll = frame * 1.3f;
+    *yaw = -8.0f;
+}
+
+// Pitch swinging through +90 and -90, where yaw and roll degenerate
+static void traj_gimbal_lock(int frame, float *pitch, float *roll, float *yaw)
+{
+    float swing = (frame % 40) * 0.2f - 4.0f;
+
+    *pitch = (frame / 40) % 2 ? -90.0f + swing : 90.0f + swing;
+    *roll = frame * 3.0f;
+    *yaw = frame * 2.0f;
+}
+
+const trajectory_t trajectories[] = {
+    { "static",       traj_static },
+    { "slow roll",    traj_slow_roll },
+    { "fast tumble",  traj_fast_tumble },
+    { "gimbal pitch", traj_gimbal_lock },
+    { "flat turn",    traj_flat_turn },
+};
+
+const int trajectory_count = sizeof(trajectories) / sizeof(trajectories[0]);
+
+// On-screen roll is the Rz term, draw_navball()'s yaw_deg: it turns the
+// disc's texel walk. Its Ry roll_deg only shifts U and is held fixed.
+#define ROLL_TRAJECTORY(deg) \
+    static void traj_roll_##deg(int frame, float *pitch, float *roll, float *yaw) \
+    { \
+        *pitch = 12.0f; \
+        *roll = -8.0f; \
+        *yaw = deg + (frame & 1) * 0.5f; \
+    }
+
+ROLL_TRAJECTORY(0)
+ROLL_TRAJECTORY(30)
+ROLL_TRAJECTORY(60)
+ROLL_TRAJECTORY(90)
+
+const trajectory_t roll_trajectories[] = {
+    { "roll 0",   traj_roll_0 },
+    { "roll 30",  traj_roll_30 },
+    { "roll 60",  traj_roll_60 },
+    { "roll 90",  traj_roll_90 },
+};
+
+const int roll_trajectory_count = sizeof(roll_trajectories) / sizeof(roll_trajectories[0]);
@@ -0,0 +1,21 @@
+#ifndef __TRAJECTORY_H
+#define __TRAJECTORY_H
+
+/**
+ * Attitude sequences shared by the host benchmarks
+ */
+typedef struct {
+    const char *name;
+    void (*attitude)(int frame, float *pitch, float *roll, float *yaw);
+} trajectory_t;
+
+extern const trajectory_t trajectories[];
+extern const int trajectory_count;
+
+// Fixed attitudes at increasing on-screen roll (the Rz angle, passed
+// as yaw): the disc's texture walk turns from along rows (0 deg) to
+// along columns (90 deg)
+extern const trajectory_t roll_trajectories[];
+extern const int roll_trajectory_count;
+
+#endif
@@ -6,10 +6,12 @@ KSP_ARTIFICIAL_HORIZON_VERSION = 1.0
 KSP_ARTIFICIAL_HORIZON_SITE = /home/hdani/buildroot/package/ksp-artificial-horizon
 KSP_ARTIFICIAL_HORIZON_SITE_METHOD = local
 
-KSP_ARTIFICIAL_HORIZON_DEPENDENCIES = libgpiod
+KSP_ARTIFICIAL_HORIZON_DEPENDENCIES = libgpiod host-libpng
 
 define KSP_ARTIFICIAL_HORIZON_BUILD_CMDS
-	$(MAKE) CC="$(TARGET_CC)" -C $(@D)
+	$(MAKE) CC="$(TARGET_CC)" HOSTCC="$(HOSTCC)" \
+		HOST_CFLAGS="$(HOST_CFLAGS)" HOST_LDFLAGS="$(HOST_LDFLAGS)" -C $(@D) \
+		all textures
 endef
 
 define KSP_ARTIFICIAL_HORIZON_INSTALL_INIT_SYSV
@@ -20,6 +22,10 @@ endef
 define KSP_ARTIFICIAL_HORIZON_INSTALL_TARGET_CMDS
 	$(INSTALL) -D -m 0755 $(@D)/lcd_app \
 		$(TARGET_DIR)/usr/bin/lcd_app
+	$(INSTALL) -D -m 0644 $(@D)/navball_256x128.tex \
+		$(TARGET_DIR)/usr/share/ksp-artificial-horizon/navball_256x128.tex
+	$(INSTALL) -D -m 0644 $(@D)/navball_512x256.tex \
+		$(TARGET_DIR)/usr/share/ksp-artificial-horizon/navball_512x256.tex
 endef
 
 $(eval $(generic-package))
@@ -0,0 +1,60 @@
+#ifndef __ATTITUDE_H_
+#define __ATTITUDE_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// sender_us holds the sender's clock (framed protocol only)
+#define ATTITUDE_SENDER_TIME    0x01
+
+typedef struct {
+    int16_t pitch;      // degrees
+    int16_t roll;
+    int16_t yaw;
+    uint16_t seq;       // sender sequence number, framed protocol only
+    uint32_t sender_us;
+    uint8_t flags;
+    uint64_t rx_us;     // local monotonic time the packet arrived
+} attitude_t;
+
+/**
+ * Latest attitude, handed from the UART thread to the renderer through
+ * a seqlock: the writer never blocks and never waits for the reader,
+ * the reader retries if it raced a write. One writer only.
+ */
+typedef struct {
+    atomic_uint seq;        // odd while a write is in progress
+    attitude_t value;
+} attitude_box_t;
+
+static inline void attitude_publish(attitude_box_t *box, const attitude_t *a)
+{
+    unsigned seq = atomic_load_explicit(&box->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&box->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    box->value = *a;
+
+    atomic_store_explicit(&box->seq, seq + 2, memory_order_release);
+}
+
+/**
+ * Copy the latest attitude, returns its sequence number (changes with
+ * every publish)
+ */
+static inline unsigned attitude_read(attitude_box_t *box, attitude_t *a)
+{
+    unsigned s1, s2;
+
+    do {
+        s1 = atomic_load_explicit(&box->seq, memory_order_acquire);
+        *a = box->value;
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&box->seq, memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+
+    return s1;
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include "attitude_filter.h"
+#include <math.h>
+#include <string.h>
+
+// Float conversions, horizon.h has the double DEG_TO_RAD of the renderer
+#define DEG_TO_RAD_F    (3.14159265f / 180.0f)
+#define RAD_TO_DEG_F    (180.0f / 3.14159265f)
+
+static quat_t quat_mul(const quat_t *a, const quat_t *b)
+{
+    quat_t r = {
+        a->w*b->w - a->x*b->x - a->y*b->y - a->z*b->z,
+        a->w*b->x + a->x*b->w + a->y*b->z - a->z*b->y,
+        a->w*b->y - a->x*b->z + a->y*b->w + a->z*b->x,
+        a->w*b->z + a->x*b->y - a->y*b->x + a->z*b->w,
+    };
+    return r;
+}
+
+quat_t quat_from_euler(float pitch, float roll, float yaw)
+{
+    float hp = pitch * DEG_TO_RAD_F * 0.5f;
+    float hr = roll  * DEG_TO_RAD_F * 0.5f;
+    float hw = yaw   * DEG_TO_RAD_F * 0.5f;
+
+    quat_t qr = { cosf(hr), 0, sinf(hr), 0 };   // roll around Y
+    quat_t qp = { cosf(hp), sinf(hp), 0, 0 };   // pitch around X
+    quat_t qw = { cosf(hw), 0, 0, sinf(hw) };   // yaw around Z
+
+    quat_t t = quat_mul(&qr, &qp);
+    return quat_mul(&t, &qw);
+}
+
+void quat_to_euler(const quat_t *q, float *pitch, float *roll, float *yaw)
+{
+    float w = q->w, x = q->x, y = q->y, z = q->z;
+
+    // Matrix elements navball_rotation_matrix() would produce
+    float m0 = 1 - 2*(y*y + z*z);
+    float m1 = 2*(x*y - w*z);
+    float m2 = 2*(x*z + w*y);
+    float m3 = 2*(x*y + w*z);
+    float m4 = 1 - 2*(x*x + z*z);
+    float m5 = 2*(y*z - w*x);
+    float m8 = 1 - 2*(x*x + y*y);
+
+    float sp = -m5;
+    if (sp > 1) sp = 1;
+    if (sp < -1) sp = -1;
+
+    *pitch = asinf(sp) * RAD_TO_DEG_F;
+
+    if (fabsf(sp) < 0.9999f) {
+        *roll = atan2f(m2, m8) * RAD_TO_DEG_F;
+        *yaw = atan2f(m3, m4) * RAD_TO_DEG_F;
+    } else {
+        // Gimbal lock: only roll -/+ yaw is defined, put it all in roll
+        *roll = atan2f(sp * m1, m0) * RAD_TO_DEG_F;
+        *yaw = 0;
+    }
+}
+
+quat_t quat_slerp(const quat_t *a, const quat_t *b, float t)
+{
+    quat_t e = *b;
+    float d = a->w*e.w + a->x*e.x + a->y*e.y + a->z*e.z;
+
+    // q and -q are the same rotation, take the short way round
+    if (d < 0) {
+        d = -d;
+        e.w = -e.w; e.x = -e.x; e.y = -e.y; e.z = -e.z;
+    }
+
+    float ka, kb;
+
+    if (d > 0.9995f) {
+        // Nearly parallel, lerp and normalize
+        ka = 1 - t;
+        kb = t;
+    } else {
+        float theta = acosf(d);
+        float s = sinf(theta);
+        ka = sinf((1 - t) * theta) / s;
+        kb = sinf(t * theta) / s;
+    }
+
+    quat_t r = {
+        ka*a->w + kb*e.w, ka*a->x + kb*e.x,
+        ka*a->y + kb*e.y, ka*a->z + kb*e.z,
+    };
+
+    float n = sqrtf(r.w*r.w + r.x*r.x + r.y*r.y + r.z*r.z);
+    if (n > 0) {
+        r.w /= n; r.x /= n; r.y /= n; r.z /= n;
+    }
+
+    return r;
+}
+
+float quat_angle(const quat_t *a, const quat_t *b)
+{
+    float d = fabsf(a->w*b->w + a->x*b->x + a->y*b->y + a->z*b->z);
+    if (d > 1) d = 1;
+
+    return 2 * acosf(d);
+}
+
+void attitude_filter_init(attitude_filter_t *f, attitude_mode_t mode)
+{
+    memset(f, 0, sizeof(*f));
+    f->mode = mode;
+}
+
+// i-th newest sample, 0 is the latest
+static const attitude_sample_t *nth_newest(const attitude_filter_t *f, int i)
+{
+    return &f->samples[(f->head - 1 - i + ATTITUDE_HISTORY) % ATTITUDE_HISTORY];
+}
+
+void attitude_filter_push(attitude_filter_t *f, const attitude_t *a)
+{
+    if (f->count > 0) {
+        uint64_t last = nth_newest(f, 0)->t_us;
+
+        // Several packets in one read() share a stamp, keep the newest
+        if (a->rx_us <= last) {
+            f->head = (f->head - 1 + ATTITUDE_HISTORY) % ATTITUDE_HISTORY;
+            f->count--;
+        } else {
+            uint32_t dt = a->rx_us - last;
+            f->interval_us = f->interval_us ? (f->interval_us * 7 + dt) / 8 : dt;
+        }
+    }
+
+    f->latest = *a;
+
+    attitude_sample_t *s = &f->samples[f->head];
+    s->t_us = a->rx_us;
+    s->q = quat_from_euler(a->pitch, a->roll, a->yaw);
+
+    f->head = (f->head + 1) % ATTITUDE_HISTORY;
+    if (f->count < ATTITUDE_HISTORY)
+        f->count++;
+}
+
+static quat_t between(const attitude_sample_t *s0, const attitude_sample_t *s1,
+                      uint64_t t_us)
+{
+    // Subtract as integers, a float has only 24 bits for a monotonic stamp
+    float span = (float)(s1->t_us - s0->t_us);
+    float u = (float)(int64_t)(t_us - s0->t_us) / span;
+
+    return quat_slerp(&s0->q, &s1->q, u);
+}
+
+int attitude_filter_sample(const attitude_filter_t *f, uint64_t now_us,
+                           float *pitch, float *roll, float *yaw)
+{
+    if (f->count == 0)
+        return 0;
+
+    // Exact packet angles, no round trip through a quaternion
+    if (f->mode == ATTITUDE_HOLD || f->count < 2) {
+        *pitch = f->latest.pitch;
+        *roll = f->latest.roll;
+        *yaw = f->latest.yaw;
+        return 1;
+    }
+
+    const attitude_sample_t *newest = nth_newest(f, 0);
+    quat_t q = newest->q;
+
+    if (f->mode == ATTITUDE_EXTRAPOLATE) {
+        uint64_t t = now_us;
+        if (t > newest->t_us + ATTITUDE_MAX_EXTRAPOLATE_US)
+            t = newest->t_us + ATTITUDE_MAX_EXTRAPOLATE_US;
+
+        if (t > newest->t_us)
+            q = between(nth_newest(f, 1), newest, t);
+    } else {
+        uint64_t t = now_us - f->interval_us;
+
+        // Newest pair bracketing t, oldest sample if t is before them all
+        for (int i = 0; i < f->count - 1; i++) {
+            const attitude_sample_t *s1 = nth_newest(f, i);
+            const attitude_sample_t *s0 = nth_newest(f, i + 1);
+
+            if (t >= s1->t_us)
+                break;
+            if (t >= s0->t_us) {
+                q = between(s0, s1, t);
+                break;
+            }
+            q = s0->q;
+        }
+    }
+
+    quat_to_euler(&q, pitch, roll, yaw);
+    return 1;
+}
+
+int attitude_filter_settled(const attitude_filter_t *f, uint64_t now_us)
+{
+    if (f->count < 2 || f->mode == ATTITUDE_HOLD)
+        return 1;
+
+    uint64_t newest = nth_newest(f, 0)->t_us;
+
+    if (f->mode == ATTITUDE_EXTRAPOLATE)
+        return now_us >= newest + ATTITUDE_MAX_EXTRAPOLATE_US;
+
+    return now_us >= newest + f->interval_us;
+}
@@ -0,0 +1,88 @@
+#ifndef __ATTITUDE_FILTER_H_
+#define __ATTITUDE_FILTER_H_
+
+#include <stdint.h>
+#include "attitude.h"
+
+/**
+ * Attitude history for rendering between packets. Samples are kept as
+ * quaternions stamped with their arrival time, the renderer asks for
+ * the attitude at any instant:
+ *
+ *  HOLD         newest packet as is (no filtering)
+ *  EXTRAPOLATE  continue the last two samples' rotation past the newest
+ *               one, lowest latency, overshoots on sudden stops
+ *  INTERPOLATE  slerp between the two samples around now minus one
+ *               packet interval, smoothest, one packet behind
+ *
+ * Owned by the render thread, no locking.
+ */
+typedef enum {
+    ATTITUDE_HOLD,
+    ATTITUDE_EXTRAPOLATE,
+    ATTITUDE_INTERPOLATE,
+} attitude_mode_t;
+
+typedef struct {
+    float w, x, y, z;
+} quat_t;
+
+typedef struct {
+    uint64_t t_us;
+    quat_t q;
+} attitude_sample_t;
+
+#define ATTITUDE_HISTORY            8
+
+// Extrapolation stops this far past the newest sample
+#define ATTITUDE_MAX_EXTRAPOLATE_US 100000
+
+typedef struct {
+    attitude_mode_t mode;
+    attitude_sample_t samples[ATTITUDE_HISTORY];    // ring, oldest first
+    int head;           // next slot to write
+    int count;
+    uint32_t interval_us;   // smoothed packet interval
+    attitude_t latest;      // as received, for HOLD
+} attitude_filter_t;
+
+void attitude_filter_init(attitude_filter_t *f, attitude_mode_t mode);
+
+/**
+ * Add a received attitude, stamped with a->rx_us
+ */
+void attitude_filter_push(attitude_filter_t *f, const attitude_t *a);
+
+/**
+ * Attitude to render at now_us, in degrees. Returns 0 (outputs
+ * untouched) until the first sample arrived.
+ */
+int attitude_filter_sample(const attitude_filter_t *f, uint64_t now_us,
+                           float *pitch, float *roll, float *yaw);
+
+/**
+ * 1 if the output of attitude_filter_sample() stays the same from now_us
+ * on unless a new sample arrives
+ */
+int attitude_filter_settled(const attitude_filter_t *f, uint64_t now_us);
+
+/**
+ * Quaternion of the navball rotation, R = Roll(Y) * Pitch(X) * Yaw(Z)
+ * as in navball_rotation_matrix(), angles in degrees
+ */
+quat_t quat_from_euler(float pitch, float roll, float yaw);
+
+void quat_to_euler(const quat_t *q, float *pitch, float *roll, float *yaw);
+
+/**
+ * Spherical interpolation along the shorter arc, t outside [0, 1]
+ * extrapolates along the same arc
+ */
+quat_t quat_slerp(const quat_t *a, const quat_t *b, float t);
+
+/**
+ * Angle of the rotation taking a to b, radians
+ */
+float quat_angle(const quat_t *a, const quat_t *b);
+
+#endif
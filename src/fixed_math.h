@@ -0,0 +1,29 @@
+#ifndef __FIXED_MATH_H_
+#define __FIXED_MATH_H_
+
+#include <stdint.h>
+
+/**
+ * Integer trigonometry for the fixed-point navball pipeline.
+ *
+ * Angles are binary angles (BAM): 65536 units per turn, so wrapping is
+ * free uint16_t overflow. Sines, cosines and unit vectors are Q15.
+ */
+
+#define Q15_ONE     32768
+#define BAM_HALF    32768
+#define BAM_QUARTER 16384
+
+/**
+ * Table based sine/cosine, 1024 steps per turn, linearly interpolated
+ */
+int32_t q15_sin(uint16_t bam);
+
+int32_t q15_cos(uint16_t bam);
+
+/**
+ * CORDIC atan2, returns the angle of (x, y) in BAM, range [-32768, 32768]
+ */
+int32_t bam_atan2(int32_t y, int32_t x);
+
+#endif
@@ -0,0 +1,76 @@
+#include "frame_pacer.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#define NSEC_PER_SEC    1000000000ULL
+
+static uint64_t ts_to_ns(const struct timespec *ts)
+{
+    return (uint64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static void ns_to_ts(uint64_t ns, struct timespec *ts)
+{
+    ts->tv_sec = ns / NSEC_PER_SEC;
+    ts->tv_nsec = ns % NSEC_PER_SEC;
+}
+
+int frame_pacer_init(frame_pacer_t *p, int fps)
+{
+    memset(p, 0, sizeof(*p));
+
+    p->period_ns = fps > 0 ? NSEC_PER_SEC / fps : 0;
+    clock_gettime(CLOCK_MONOTONIC, &p->deadline);
+
+    p->event_fd = eventfd(0, EFD_CLOEXEC);
+    if (p->event_fd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+
+    return 0;
+}
+
+void frame_pacer_notify(frame_pacer_t *p)
+{
+    uint64_t one = 1;
+
+    if (write(p->event_fd, &one, sizeof(one)) < 0)
+        perror("eventfd write");
+}
+
+void frame_pacer_wait_frame(frame_pacer_t *p)
+{
+    if (!p->period_ns)
+        return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t next = ts_to_ns(&p->deadline);
+    uint64_t now_ns = ts_to_ns(&now);
+
+    if (now_ns > next + p->period_ns)
+        next = now_ns;
+    else
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &p->deadline, NULL);
+
+    ns_to_ts(next + p->period_ns, &p->deadline);
+}
+
+void frame_pacer_wait_event(frame_pacer_t *p, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = p->event_fd, .events = POLLIN };
+
+    if (poll(&pfd, 1, timeout_ms) > 0) {
+        uint64_t count;
+        if (read(p->event_fd, &count, sizeof(count)) < 0)
+            perror("eventfd read");
+    }
+
+    // Idle time does not count against the frame slots
+    clock_gettime(CLOCK_MONOTONIC, &p->deadline);
+}
@@ -0,0 +1,37 @@
+#ifndef __FRAME_PACER_H_
+#define __FRAME_PACER_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Render loop pacing: frames start on absolute CLOCK_MONOTONIC
+ * deadlines at most fps times a second, and an idle renderer sleeps on
+ * an eventfd until the UART side reports a new attitude.
+ */
+typedef struct {
+    uint64_t period_ns;         // 0: uncapped
+    struct timespec deadline;   // start of the next frame slot
+    int event_fd;
+} frame_pacer_t;
+
+int frame_pacer_init(frame_pacer_t *p, int fps);
+
+/**
+ * New attitude available, wakes frame_pacer_wait_event(). Any thread.
+ */
+void frame_pacer_notify(frame_pacer_t *p);
+
+/**
+ * Sleep until the next frame slot. A renderer that fell more than one
+ * period behind starts over from now instead of bursting to catch up.
+ */
+void frame_pacer_wait_frame(frame_pacer_t *p);
+
+/**
+ * Block until frame_pacer_notify() or timeout_ms (-1: forever).
+ * Notifications since the last call return immediately.
+ */
+void frame_pacer_wait_event(frame_pacer_t *p, int timeout_ms);
+
+#endif
@@ -0,0 +1,99 @@
+#include "frame_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int frame_queue_init(frame_queue_t *q, int w, int h)
+{
+    memset(q, 0, sizeof(*q));
+
+    // Allocated once and reused for every frame
+    size_t bytes = w * h * sizeof(uint16_t);
+
+    for (int i = 0; i < FRAME_QUEUE_DEPTH; i++) {
+        void *pixels;
+        if (posix_memalign(&pixels, FRAME_ALIGN, bytes) != 0) {
+            printf("Unable to allocate framebuffer %d...\n", i);
+            return -1;
+        }
+        memset(pixels, 0, bytes);
+        q->frames[i].pixels = pixels;
+    }
+
+    q->render = 0;
+    q->ready = -1;
+    q->sending = -1;
+    q->last = 0;
+
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->ready_cond, NULL);
+
+    return 0;
+}
+
+frame_t *frame_queue_render_target(frame_queue_t *q, const uint16_t **prev)
+{
+    pthread_mutex_lock(&q->lock);
+    frame_t *f = &q->frames[q->render];
+    *prev = q->frames[q->last].pixels;
+    pthread_mutex_unlock(&q->lock);
+
+    return f;
+}
+
+static void rect_union(fb_rect_t *a, const fb_rect_t *b)
+{
+    if (b->x0 < a->x0) a->x0 = b->x0;
+    if (b->y0 < a->y0) a->y0 = b->y0;
+    if (b->x1 > a->x1) a->x1 = b->x1;
+    if (b->y1 > a->y1) a->y1 = b->y1;
+}
+
+void frame_queue_publish(frame_queue_t *q, const fb_rect_t *dirty)
+{
+    pthread_mutex_lock(&q->lock);
+
+    frame_t *f = &q->frames[q->render];
+    f->dirty = *dirty;
+
+    // Frame not picked up in time: drop it, but keep its changes
+    if (q->ready >= 0)
+        rect_union(&f->dirty, &q->frames[q->ready].dirty);
+
+    q->ready = q->render;
+    q->last = q->render;
+
+    // Next render target: any buffer neither queued nor on the wire
+    for (int i = 0; i < FRAME_QUEUE_DEPTH; i++) {
+        if (i != q->ready && i != q->sending) {
+            q->render = i;
+            break;
+        }
+    }
+
+    pthread_cond_signal(&q->ready_cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+frame_t *frame_queue_take(frame_queue_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+
+    while (q->ready < 0)
+        pthread_cond_wait(&q->ready_cond, &q->lock);
+
+    q->sending = q->ready;
+    q->ready = -1;
+    frame_t *f = &q->frames[q->sending];
+
+    pthread_mutex_unlock(&q->lock);
+
+    return f;
+}
+
+void frame_queue_release(frame_queue_t *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->sending = -1;
+    pthread_mutex_unlock(&q->lock);
+}
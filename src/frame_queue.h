@@ -0,0 +1,61 @@
+#ifndef __FRAME_QUEUE_H_
+#define __FRAME_QUEUE_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include "horizon.h"
+#include "attitude.h"
+
+// Render target, frame waiting for transmit, frame on the wire
+#define FRAME_QUEUE_DEPTH   3
+
+// Framebuffers are page aligned, SPI transfers point straight into them
+#define FRAME_ALIGN         4096
+
+typedef struct {
+    uint16_t *pixels;
+    fb_rect_t dirty;        // change vs the previously published frame
+    attitude_t source;      // newest packet the frame was rendered from
+} frame_t;
+
+/**
+ * Zero-copy handoff of framebuffers between the render thread and the
+ * SPI transmit thread. Only buffer indices move between the two sides,
+ * a newer frame replaces one the transmitter has not picked up yet.
+ */
+typedef struct {
+    frame_t frames[FRAME_QUEUE_DEPTH];
+
+    int render;     // owned by the renderer
+    int ready;      // published, waiting for transmit (-1 if none)
+    int sending;    // owned by the transmitter (-1 if none)
+    int last;       // most recently published frame
+
+    pthread_mutex_t lock;
+    pthread_cond_t ready_cond;
+} frame_queue_t;
+
+int frame_queue_init(frame_queue_t *q, int w, int h);
+
+/**
+ * Buffer to render the next frame into, and the last published frame
+ * it has to be diffed against
+ */
+frame_t *frame_queue_render_target(frame_queue_t *q, const uint16_t **prev);
+
+/**
+ * Hand the render target over to the transmit side
+ */
+void frame_queue_publish(frame_queue_t *q, const fb_rect_t *dirty);
+
+/**
+ * Block until a frame is published and take ownership of it
+ */
+frame_t *frame_queue_take(frame_queue_t *q);
+
+/**
+ * Give the frame taken by frame_queue_take() back to the renderer
+ */
+void frame_queue_release(frame_queue_t *q);
+
+#endif
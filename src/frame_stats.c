@@ -0,0 +1,122 @@
+#include "frame_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+frame_stats_ring_t frame_stats[STAGE_COUNT];
+
+static const char *stage_names[STAGE_COUNT] = {
+    "acquire", "render", "overlay", "push", "rx2wire", "tx2wire"
+};
+
+const uint32_t frame_stats_bucket_us[FRAME_STATS_BUCKETS] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, UINT32_MAX
+};
+
+const char *frame_stats_stage_name(frame_stage_t stage)
+{
+    return stage < STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+void frame_stats_summarize(frame_stage_t stage, frame_stats_summary_t *s)
+{
+    frame_stats_ring_t *r = &frame_stats[stage];
+    static uint32_t sorted[FRAME_STATS_RING];
+
+    memset(s, 0, sizeof(*s));
+
+    uint64_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t n = head < FRAME_STATS_RING ? head : FRAME_STATS_RING;
+
+    s->total = head;
+    s->count = n;
+    if (!n)
+        return;
+
+    for (uint32_t i = 0; i < n; i++)
+        sorted[i] = r->samples[(head - n + i) & (FRAME_STATS_RING - 1)];
+
+    qsort(sorted, n, sizeof(sorted[0]), cmp_u32);
+
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+        sum += sorted[i];
+
+    s->min_us = sorted[0];
+    s->avg_us = sum / n;
+    s->p99_us = sorted[(uint64_t)(n - 1) * 99 / 100];
+    s->max_us = sorted[n - 1];
+}
+
+void frame_stats_histogram(frame_stage_t stage,
+                           uint32_t counts[FRAME_STATS_BUCKETS])
+{
+    frame_stats_ring_t *r = &frame_stats[stage];
+
+    memset(counts, 0, FRAME_STATS_BUCKETS * sizeof(counts[0]));
+
+    uint64_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t n = head < FRAME_STATS_RING ? head : FRAME_STATS_RING;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t us = r->samples[(head - n + i) & (FRAME_STATS_RING - 1)];
+
+        int b = 0;
+        while (us > frame_stats_bucket_us[b])
+            b++;
+        counts[b]++;
+    }
+}
+
+void frame_stats_print_histogram(FILE *f, frame_stage_t stage)
+{
+    uint32_t counts[FRAME_STATS_BUCKETS];
+    frame_stats_histogram(stage, counts);
+
+    fprintf(f, "%-8s", stage_names[stage]);
+    for (int b = 0; b < FRAME_STATS_BUCKETS - 1; b++)
+        fprintf(f, " <=%ums:%u", frame_stats_bucket_us[b] / 1000, counts[b]);
+    fprintf(f, " more:%u\n", counts[FRAME_STATS_BUCKETS - 1]);
+}
+
+int frame_stats_write(const char *path, void (*append)(FILE *f))
+{
+    char tmp[256];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "w");
+    if (!f)
+        return -1;
+
+    fprintf(f, "%-8s %10s %8s %8s %8s %8s\n",
+            "stage", "samples", "min_us", "avg_us", "p99_us", "max_us");
+
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        frame_stats_summary_t s;
+        frame_stats_summarize(i, &s);
+
+        fprintf(f, "%-8s %10llu %8u %8u %8u %8u\n",
+                stage_names[i], (unsigned long long)s.total,
+                s.min_us, s.avg_us, s.p99_us, s.max_us);
+    }
+
+    fprintf(f, "\n");
+    frame_stats_print_histogram(f, STAGE_RX_TO_WIRE);
+    frame_stats_print_histogram(f, STAGE_SENDER_TO_WIRE);
+
+    if (append)
+        append(f);
+
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#ifndef __FRAME_STATS_H_
+#define __FRAME_STATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+/**
+ * Per-stage frame timing. Every stage has a single writer thread that
+ * appends durations to a ring; readers summarize the most recent
+ * samples without taking a lock, an old slot overwritten mid-read only
+ * skews one sample.
+ */
+
+typedef enum {
+    STAGE_ACQUIRE,      // attitude sample from the UART thread
+    STAGE_RENDER,       // draw_navball
+    STAGE_OVERLAY,      // overlays on top of the navball
+    STAGE_PUSH,         // st7735s push on the transmit thread
+    STAGE_RX_TO_WIRE,   // packet arrival to its frame's push completing
+    STAGE_SENDER_TO_WIRE,   // sender timestamp to push completing
+    STAGE_COUNT
+} frame_stage_t;
+
+// Samples kept per stage, power of two
+#define FRAME_STATS_RING    1024
+
+typedef struct {
+    uint32_t samples[FRAME_STATS_RING];     // microseconds
+    atomic_uint_fast64_t head;              // total samples written
+} frame_stats_ring_t;
+
+typedef struct {
+    uint32_t count;     // samples summarized
+    uint64_t total;     // samples recorded since start
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} frame_stats_summary_t;
+
+extern frame_stats_ring_t frame_stats[STAGE_COUNT];
+
+const char *frame_stats_stage_name(frame_stage_t stage);
+
+static inline void frame_stats_record(frame_stage_t stage, uint64_t us)
+{
+    frame_stats_ring_t *r = &frame_stats[stage];
+    uint64_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+    r->samples[head & (FRAME_STATS_RING - 1)] = us > UINT32_MAX ? UINT32_MAX : us;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+/**
+ * min/avg/p99/max over the last FRAME_STATS_RING samples of stage.
+ * Not reentrant, meant for a single stats reporting thread.
+ */
+void frame_stats_summarize(frame_stage_t stage, frame_stats_summary_t *s);
+
+// Latency histogram bucket upper bounds, microseconds, last is open ended
+#define FRAME_STATS_BUCKETS     10
+
+extern const uint32_t frame_stats_bucket_us[FRAME_STATS_BUCKETS];
+
+/**
+ * Histogram of the last FRAME_STATS_RING samples of stage. Same
+ * threading rules as frame_stats_summarize().
+ */
+void frame_stats_histogram(frame_stage_t stage,
+                           uint32_t counts[FRAME_STATS_BUCKETS]);
+
+/**
+ * Print the histogram of stage as one line
+ */
+void frame_stats_print_histogram(FILE *f, frame_stage_t stage);
+
+/**
+ * Write all stage summaries to path, replaced atomically via rename so
+ * readers never see a partial file. append (optional) adds its own
+ * lines after the stage table.
+ */
+int frame_stats_write(const char *path, void (*append)(FILE *f));
+
+#endif
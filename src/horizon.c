@@ -1,13 +1,85 @@
 #include "horizon.h"
 #include "st7735s.h"
-#include "navball_texture_256_128.h"
+#include "texture.h"
+#include "navball_uv.h"
+#include "texture_layout.h"
+#include "fixed_math.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <math.h>
 
-static uint16_t framebuffer[FB_WIDTH * FB_HEIGHT];
+#if defined(HORIZON_NEON)
+#if !defined(__ARM_NEON) && !defined(__ARM_NEON__)
+#error "HORIZON_NEON needs a NEON capable target (-mfpu=neon)"
+#endif
+#include <arm_neon.h>
+#endif
+
+#if defined(HORIZON_FIXED_POINT) && defined(HORIZON_NEON)
+#error "HORIZON_FIXED_POINT and HORIZON_NEON are mutually exclusive"
+#endif
+
+static uint16_t default_framebuffer[FB_WIDTH * FB_HEIGHT] __attribute__((aligned(64)));
+
+// Render target and the previous frame that changes are tracked against
+static uint16_t *framebuffer = default_framebuffer;
+static const uint16_t *prev_framebuffer = default_framebuffer;
+
+// Bounding box of the pixels that differ from prev_framebuffer
+static fb_rect_t dirty = { FB_WIDTH, FB_HEIGHT, -1, -1 };
+
+/**
+ * Pixels inside the navball disc and their unit sphere normals.
+ * Stored as structure of arrays so the per-frame loop streams through
+ * each component linearly. Filled once by horizon_init().
+ */
+static struct {
+    int count;
+    uint16_t fb_index[NAVBALL_MAX_PIXELS];
+    float nx[NAVBALL_MAX_PIXELS] __attribute__((aligned(16)));
+    float ny[NAVBALL_MAX_PIXELS] __attribute__((aligned(16)));
+    float nz[NAVBALL_MAX_PIXELS] __attribute__((aligned(16)));
+#if defined(HORIZON_FIXED_POINT)
+    int16_t qx[NAVBALL_MAX_PIXELS];     // Q15 copies of the normals
+    int16_t qy[NAVBALL_MAX_PIXELS];
+    int16_t qz[NAVBALL_MAX_PIXELS];
+#endif
+} navball_cache;
+
+// Texture sampled by draw_navball(), see horizon_set_texture()
+static texture_t navball_tex;
+
+/**
+ * Heading mode UV map (draw_navball_heading()): longitude in BAM and
+ * texture row of every disc pixel under the inner Rx(pitch) * Rz(yaw)
+ * of draw_navball(), before its Ry(roll). Keyed on pitch and yaw as
+ * draw_navball() resolves them: sine table index in the float build,
+ * BAM in the fixed-point one. Rebuilt when the key or the texture
+ * changes.
+ */
+static struct {
+    int valid;
+    uint16_t pitch, yaw;
+    uint16_t u[NAVBALL_MAX_PIXELS];
+    uint8_t ty[NAVBALL_MAX_PIXELS];
+} heading_map;
+
+#if defined(HORIZON_FIXED_POINT)
+
+#define ROW_LUT_SHIFT   5
+#define ROW_LUT_SIZE    (65536 >> ROW_LUT_SHIFT)
+
+/**
+ * Texture row lookup for the fixed-point path: Q15 sine of the lower
+ * latitude of every row, and a coarse y -> row table that is refined
+ * against it. Replaces asin() + scale per pixel.
+ */
+static int32_t fx_row_start[TEXTURE_MAX_HEIGHT + 1];
+static uint8_t fx_row_lut[ROW_LUT_SIZE];
+
+#endif
 
 const float sin_table[TABLE_SIZE] = {
           0.0f,      0.01f,  0.019999f,  0.029996f,  0.039989f,  0.049979f,  0.059964f,  0.069943f,
@@ -180,20 +252,41 @@ static float wrap_angle(float rad) {
     return rad;
 }
 
-// Sine lookup using table
-float fsin(float rad) {
+// Table entry fsin()/fcos() read for rad
+static int table_index(float rad) {
     rad = wrap_angle(rad);
     int index = (int)(rad / STEP_RAD);
     if (index >= TABLE_SIZE) index = TABLE_SIZE - 1;
-    return sin_table[index];
+    return index;
+}
+
+// Sine lookup using table
+float fsin(float rad) {
+    return sin_table[table_index(rad)];
 }
 
 // Cosine lookup using table
 float fcos(float rad) {
-    rad = wrap_angle(rad);
-    int index = (int)(rad / STEP_RAD);
-    if (index >= TABLE_SIZE) index = TABLE_SIZE - 1;
-    return cos_table[index];
+    return cos_table[table_index(rad)];
+}
+
+static inline void fb_mark_dirty(int x, int y)
+{
+    if (x < dirty.x0) dirty.x0 = x;
+    if (x > dirty.x1) dirty.x1 = x;
+    if (y < dirty.y0) dirty.y0 = y;
+    if (y > dirty.y1) dirty.y1 = y;
+}
+
+// Colours are in panel byte order (FB_COLOR()), no swap on the way out
+static inline void fb_put_pixel(int x, int y, uint16_t color)
+{
+    int idx = y * FB_WIDTH + x;
+    uint16_t old = prev_framebuffer[idx];
+
+    framebuffer[idx] = color;
+    if (old != color)
+        fb_mark_dirty(x, y);
 }
 
 static inline void fb_set_pixel(int x, int y, uint16_t color)
@@ -201,15 +294,31 @@ static inline void fb_set_pixel(int x, int y, uint16_t color)
     if (x < 0 || x >= FB_WIDTH) return;
     if (y < 0 || y >= FB_HEIGHT) return;
 
-    color = (color >> 8) | (color << 8);
-
-    framebuffer[y * FB_WIDTH + x] = color;
+    fb_put_pixel(x, y, color);
 }
 
 void fb_clear(uint16_t color)
 {
     for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++)
         framebuffer[i] = color;
+
+    fb_mark_dirty(0, 0);
+    fb_mark_dirty(FB_WIDTH - 1, FB_HEIGHT - 1);
+}
+
+int horizon_take_dirty(fb_rect_t *rect)
+{
+    if (dirty.x1 < dirty.x0)
+        return 0;
+
+    *rect = dirty;
+
+    dirty.x0 = FB_WIDTH;
+    dirty.y0 = FB_HEIGHT;
+    dirty.x1 = -1;
+    dirty.y1 = -1;
+
+    return 1;
 }
 
 uint16_t* horizon_get_framebuffer(void)
@@ -217,8 +326,15 @@ uint16_t* horizon_get_framebuffer(void)
     return framebuffer;
 }
 
-static void rotate_vec(float *x, float *y, float *z,
-                       float pitch, float roll, float yaw)
+void horizon_set_framebuffer(uint16_t *target, const uint16_t *prev)
+{
+    framebuffer = target;
+    prev_framebuffer = prev ? prev : target;
+}
+
+// Reference path: yaw, pitch and roll applied one after another
+void rotate_vec(float *x, float *y, float *z,
+                float pitch, float roll, float yaw)
 {
     float x0 = *x, y0 = *y, z0 = *z;
     float x1, y1, z1;
@@ -248,11 +364,30 @@ static void rotate_vec(float *x, float *y, float *z,
     *z = z1;
 }
 
-void draw_navball(float pitch_deg, float roll_deg, float yaw_deg)
+void navball_rotation_matrix(float m[9],
+                             float pitch, float roll, float yaw)
 {
-    float pitch = pitch_deg * (PI / 180.0f);
-    float roll  = roll_deg  * (PI / 180.0f);
-    float yaw   = yaw_deg   * (PI / 180.0f);
+    float sp = fsin(pitch), cp = fcos(pitch);
+    float sr = fsin(roll),  cr = fcos(roll);
+    float sw = fsin(yaw),   cw = fcos(yaw);
+
+    // R = Roll(Y) * Pitch(X) * Yaw(Z), same order as rotate_vec()
+    m[0] =  cr*cw + sr*sp*sw;
+    m[1] = -cr*sw + sr*sp*cw;
+    m[2] =  sr*cp;
+
+    m[3] =  cp*sw;
+    m[4] =  cp*cw;
+    m[5] = -sp;
+
+    m[6] = -sr*cw + cr*sp*sw;
+    m[7] =  sr*sw + cr*sp*cw;
+    m[8] =  cr*cp;
+}
+
+void horizon_init(void)
+{
+    int n = 0;
 
     for (int sy = cy - radius; sy <= cy + radius; sy++) {
         for (int sx = cx - radius; sx <= cx + radius; sx++) {
@@ -264,55 +399,446 @@ void draw_navball(float pitch_deg, float roll_deg, float yaw_deg)
             if (dx*dx + dy*dy > radius*radius)
                 continue;
 
+            // Disc pixels outside the framebuffer are never drawn
+            if (sx < 0 || sx >= FB_WIDTH || sy < 0 || sy >= FB_HEIGHT)
+                continue;
+
             // Convert to normalized sphere coords
             // x^2 + y^2 + z^2 = 1
             float x = dx / (float)radius;
             float y = -dy / (float)radius;  // flip Y (screen coords)
             float t = 1.0f - x*x - y*y;
             if (t < 0) t = 0;
-            float z = sqrtf(t);
 
-            // rotate sphere point
-            rotate_vec(&x, &y, &z, pitch, roll, yaw);
+            navball_cache.fb_index[n] = sy * FB_WIDTH + sx;
+            navball_cache.nx[n] = x;
+            navball_cache.ny[n] = y;
+            navball_cache.nz[n] = sqrtf(t);
+#if defined(HORIZON_FIXED_POINT)
+            navball_cache.qx[n] = (int16_t)lrintf(x * 32767.0f);
+            navball_cache.qy[n] = (int16_t)lrintf(y * 32767.0f);
+            navball_cache.qz[n] = (int16_t)lrintf(navball_cache.nz[n] * 32767.0f);
+#endif
+            n++;
+        }
+    }
+
+    navball_cache.count = n;
+
+    if (!navball_tex.texels)
+        horizon_set_texture(NULL);
+}
 
-            // Convert sphere -> texture coordinates (UV)
-            float u = (atan2f(z, x) + PI) / (2.0f * PI);
-            float v = (asin(y) / PI) + 0.5f;
+void horizon_set_texture(const texture_t *tex)
+{
+    if (tex)
+        navball_tex = *tex;
+    else
+        texture_builtin(&navball_tex);
 
-            // Convert to texture indices
-            int tx = (int)(u * NAVBALL_TEXTURE_256_128_WIDTH);
-            int ty = (int)(v * NAVBALL_TEXTURE_256_128_HEIGHT);
+    heading_map.valid = 0;
 
-            if (tx < 0) tx = 0;
-            if (tx >= NAVBALL_TEXTURE_256_128_WIDTH) tx = NAVBALL_TEXTURE_256_128_WIDTH - 1;
-            if (ty < 0) ty = 0;
-            if (ty >= NAVBALL_TEXTURE_256_128_WIDTH) ty = NAVBALL_TEXTURE_256_128_WIDTH - 1;
+#if defined(HORIZON_FIXED_POINT)
+    const int th = navball_tex.height;
 
-            uint16_t color =
-                navball_texture_256_128[ty * NAVBALL_TEXTURE_256_128_WIDTH + tx];
+    for (int r = 0; r <= th; r++)
+        fx_row_start[r] = lrintf(sinf(PI * ((float)r / th - 0.5f)) * Q15_ONE);
 
-            fb_set_pixel(sx, sy, color);
-        }
+    int row = 0;
+    for (int b = 0; b < ROW_LUT_SIZE; b++) {
+        int32_t y = (b << ROW_LUT_SHIFT) - Q15_ONE;
+        while (row < th - 1 && y >= fx_row_start[row + 1])
+            row++;
+        fx_row_lut[b] = row;
     }
+#endif
 }
 
-void framebuffer_draw_circle(uint8_t rad, 
-                             uint16_t X0, uint16_t Y0, 
-                             uint16_t color){
+int horizon_navball_pixels(void)
+{
+    if (navball_cache.count == 0)
+        horizon_init();
+
+    return navball_cache.count;
+}
+
+static inline void navball_put_texel(int i, int texel)
+{
+    uint16_t color = navball_tex.palette[navball_tex.texels[texel]];
+    int idx = navball_cache.fb_index[i];
+
+    uint16_t old = prev_framebuffer[idx];
+
+    // Disc pixels are known to be inside the framebuffer, and the
+    // palette is already in panel byte order
+    framebuffer[idx] = color;
+    if (old != color)
+        fb_mark_dirty(idx % FB_WIDTH, idx / FB_WIDTH);
+}
+
+#if defined(HORIZON_NEON)
+
+// 1/x, estimate refined with two Newton-Raphson steps
+static inline float32x4_t neon_recip(float32x4_t x)
+{
+    float32x4_t r = vrecpeq_f32(x);
+    r = vmulq_f32(r, vrecpsq_f32(x, r));
+    r = vmulq_f32(r, vrecpsq_f32(x, r));
+    return r;
+}
+
+// sqrt(x) as x * 1/sqrt(x), x kept away from zero so the estimate stays finite
+static inline float32x4_t neon_sqrt(float32x4_t x)
+{
+    x = vmaxq_f32(x, vdupq_n_f32(1e-20f));
+    float32x4_t r = vrsqrteq_f32(x);
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+    return vmulq_f32(x, r);
+}
+
+// 4-wide fast_atan2f()
+static inline float32x4_t neon_atan2(float32x4_t y, float32x4_t x)
+{
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t ax = vabsq_f32(x), ay = vabsq_f32(y);
+    float32x4_t mx = vmaxq_f32(vmaxq_f32(ax, ay), vdupq_n_f32(1e-30f));
+    float32x4_t mn = vminq_f32(ax, ay);
+
+    float32x4_t a = vmulq_f32(mn, neon_recip(mx));
+    float32x4_t s = vmulq_f32(a, a);
+
+    float32x4_t r = vmlaq_f32(vdupq_n_f32(0.15931422f), s, vdupq_n_f32(-0.0464964749f));
+    r = vmlaq_f32(vdupq_n_f32(-0.327622764f), s, r);
+    r = vmlaq_f32(a, vmulq_f32(s, a), r);
+
+    r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(PI / 2), r), r);
+    r = vbslq_f32(vcltq_f32(x, zero), vsubq_f32(vdupq_n_f32(PI), r), r);
+    r = vbslq_f32(vcltq_f32(y, zero), vnegq_f32(r), r);
+
+    return r;
+}
+
+// 4-wide fast_asinf()
+static inline float32x4_t neon_asin(float32x4_t x)
+{
+    float32x4_t one = vdupq_n_f32(1.0f);
+    float32x4_t ax = vminq_f32(vabsq_f32(x), one);
+
+    float32x4_t p = vmlaq_f32(vdupq_n_f32(0.0742610f), ax, vdupq_n_f32(-0.0187293f));
+    p = vmlaq_f32(vdupq_n_f32(-0.2121144f), ax, p);
+    p = vmlaq_f32(vdupq_n_f32(1.5707288f), ax, p);
+
+    float32x4_t r = vmlsq_f32(vdupq_n_f32(PI / 2), neon_sqrt(vsubq_f32(one, ax)), p);
+
+    // copy the sign of x
+    uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000));
+    return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(r), sign));
+}
+
+/**
+ * Rotation, UV mapping, texel index and clamp for four pixels per
+ * iteration. Returns the number of pixels drawn (a multiple of 4),
+ * the remainder is left to the scalar loop.
+ */
+static int draw_navball_neon(const float m[9])
+{
+    const int tw = navball_tex.width;
+    const int th = navball_tex.height;
+    float32x4_t half = vdupq_n_f32(0.5f);
+    int32x4_t zero = vdupq_n_s32(0);
+    int32x4_t tx_max = vdupq_n_s32(tw - 1);
+    int32x4_t ty_max = vdupq_n_s32(th - 1);
+    int32_t texel[4] __attribute__((aligned(16)));
+    int i;
+
+    for (i = 0; i + 4 <= navball_cache.count; i += 4) {
+        float32x4_t nx = vld1q_f32(&navball_cache.nx[i]);
+        float32x4_t ny = vld1q_f32(&navball_cache.ny[i]);
+        float32x4_t nz = vld1q_f32(&navball_cache.nz[i]);
+
+        // rotate sphere points
+        float32x4_t x = vmulq_n_f32(nx, m[0]);
+        x = vmlaq_n_f32(x, ny, m[1]);
+        x = vmlaq_n_f32(x, nz, m[2]);
+        float32x4_t y = vmulq_n_f32(nx, m[3]);
+        y = vmlaq_n_f32(y, ny, m[4]);
+        y = vmlaq_n_f32(y, nz, m[5]);
+        float32x4_t z = vmulq_n_f32(nx, m[6]);
+        z = vmlaq_n_f32(z, ny, m[7]);
+        z = vmlaq_n_f32(z, nz, m[8]);
+
+        // sphere -> texture coordinates
+        float32x4_t u = vmlaq_n_f32(half, neon_atan2(z, x), (float)(1.0 / (2 * PI)));
+        float32x4_t v = vmlaq_n_f32(half, neon_asin(y), (float)(1.0 / PI));
+
+        int32x4_t tx = vcvtq_s32_f32(vmulq_n_f32(u, (float)tw));
+        int32x4_t ty = vcvtq_s32_f32(vmulq_n_f32(v, (float)th));
+        tx = vminq_s32(vmaxq_s32(tx, zero), tx_max);
+        ty = vminq_s32(vmaxq_s32(ty, zero), ty_max);
+
+#if defined(HORIZON_TEXTURE_LINEAR)
+        vst1q_s32(texel, vmlaq_n_s32(tx, ty, tw));
+#else
+        // texture_index(), four lanes
+        int32x4_t tile = vmlaq_n_s32(vshrq_n_s32(tx, TEXTURE_TILE_SHIFT),
+                                     vshrq_n_s32(ty, TEXTURE_TILE_SHIFT),
+                                     tw >> TEXTURE_TILE_SHIFT);
+        int32x4_t mask = vdupq_n_s32(TEXTURE_TILE_MASK);
+        int32x4_t idx = vshlq_n_s32(tile, 2 * TEXTURE_TILE_SHIFT);
+        idx = vaddq_s32(idx, vshlq_n_s32(vandq_s32(ty, mask), TEXTURE_TILE_SHIFT));
+        idx = vaddq_s32(idx, vandq_s32(tx, mask));
+        vst1q_s32(texel, idx);
+#endif
+
+        // no gather on NEON, fetch the texels one by one
+        navball_put_texel(i + 0, texel[0]);
+        navball_put_texel(i + 1, texel[1]);
+        navball_put_texel(i + 2, texel[2]);
+        navball_put_texel(i + 3, texel[3]);
+    }
+
+    return i;
+}
+
+#endif
+
+#if defined(HORIZON_FIXED_POINT)
+
+void navball_rotation_matrix_q15(int32_t m[9],
+                                 uint16_t pitch, uint16_t roll, uint16_t yaw)
+{
+    int32_t sp = q15_sin(pitch), cp = q15_cos(pitch);
+    int32_t sr = q15_sin(roll),  cr = q15_cos(roll);
+    int32_t sw = q15_sin(yaw),   cw = q15_cos(yaw);
+
+    int32_t srsp = (sr * sp) >> 15;
+    int32_t crsp = (cr * sp) >> 15;
+
+    // Same layout as navball_rotation_matrix(), Q15
+    m[0] = ( cr*cw + srsp*sw) >> 15;
+    m[1] = (-cr*sw + srsp*cw) >> 15;
+    m[2] = (sr*cp) >> 15;
+
+    m[3] = (cp*sw) >> 15;
+    m[4] = (cp*cw) >> 15;
+    m[5] = -sp;
+
+    m[6] = (-sr*cw + crsp*sw) >> 15;
+    m[7] = ( sr*sw + crsp*cw) >> 15;
+    m[8] = (cr*cp) >> 15;
+}
+
+void draw_navball_bam(uint16_t pitch, uint16_t roll, uint16_t yaw)
+{
+    if (navball_cache.count == 0)
+        horizon_init();
+
+    const int tw = navball_tex.width;
+    const int th = navball_tex.height;
+
+    int32_t m[9];
+    navball_rotation_matrix_q15(m, pitch, roll, yaw);
+
+    for (int i = 0; i < navball_cache.count; i++) {
+        int32_t nx = navball_cache.qx[i];
+        int32_t ny = navball_cache.qy[i];
+        int32_t nz = navball_cache.qz[i];
+
+        // rotate sphere point, Q15
+        int32_t x = (m[0]*nx + m[1]*ny + m[2]*nz) >> 15;
+        int32_t y = (m[3]*nx + m[4]*ny + m[5]*nz) >> 15;
+        int32_t z = (m[6]*nx + m[7]*ny + m[8]*nz) >> 15;
+
+        // longitude: atan2 in BAM, shifted so [-PI, PI) maps to [0, 65536)
+        uint32_t u = (uint32_t)(bam_atan2(z, x) + BAM_HALF) & 0xFFFF;
+        int tx = (u * tw) >> 16;
+
+        // latitude: coarse lookup, then step to the exact row
+        if (y > Q15_ONE - 1) y = Q15_ONE - 1;
+        if (y < -Q15_ONE)    y = -Q15_ONE;
+
+        int ty = fx_row_lut[(y + Q15_ONE) >> ROW_LUT_SHIFT];
+        while (ty < th - 1 && y >= fx_row_start[ty + 1])
+            ty++;
+
+        navball_put_texel(i, texture_index(tx, ty, tw));
+    }
+}
+
+#endif
+
+void draw_navball(float pitch_deg, float roll_deg, float yaw_deg)
+{
+#if defined(HORIZON_FIXED_POINT)
+    draw_navball_bam((uint16_t)(int32_t)(pitch_deg * (65536.0f / 360.0f)),
+                     (uint16_t)(int32_t)(roll_deg  * (65536.0f / 360.0f)),
+                     (uint16_t)(int32_t)(yaw_deg   * (65536.0f / 360.0f)));
+#else
+    float pitch = pitch_deg * (PI / 180.0f);
+    float roll  = roll_deg  * (PI / 180.0f);
+    float yaw   = yaw_deg   * (PI / 180.0f);
+
+    if (navball_cache.count == 0)
+        horizon_init();
+
+    // One rotation matrix per frame instead of table lookups per pixel
+    float m[9];
+    navball_rotation_matrix(m, pitch, roll, yaw);
+
+    int i = 0;
+
+#if defined(HORIZON_NEON)
+    i = draw_navball_neon(m);
+#endif
+
+    // Scalar path, also handles the NEON remainder
+    for (; i < navball_cache.count; i++) {
+        float nx = navball_cache.nx[i];
+        float ny = navball_cache.ny[i];
+        float nz = navball_cache.nz[i];
+
+        // rotate sphere point
+        float x = m[0]*nx + m[1]*ny + m[2]*nz;
+        float y = m[3]*nx + m[4]*ny + m[5]*nz;
+        float z = m[6]*nx + m[7]*ny + m[8]*nz;
+
+        // Convert sphere -> texture coordinates
+        int tx, ty;
+        navball_uv_texel(x, y, z, navball_tex.width, navball_tex.height, &tx, &ty);
+
+        navball_put_texel(i, texture_index(tx, ty, navball_tex.width));
+    }
+#endif
+}
+
+#if defined(HORIZON_FIXED_POINT)
+
+static void heading_map_build(uint16_t pitch, uint16_t yaw)
+{
+    const int th = navball_tex.height;
+
+    // Rx(pitch) * Rz(yaw), Ry(roll) comes later as a U shift
+    int32_t m[9];
+    navball_rotation_matrix_q15(m, pitch, 0, yaw);
+
+    for (int i = 0; i < navball_cache.count; i++) {
+        int32_t nx = navball_cache.qx[i];
+        int32_t ny = navball_cache.qy[i];
+        int32_t nz = navball_cache.qz[i];
+
+        int32_t x = (m[0]*nx + m[1]*ny + m[2]*nz) >> 15;
+        int32_t y = (m[3]*nx + m[4]*ny + m[5]*nz) >> 15;
+        int32_t z = (m[6]*nx + m[7]*ny + m[8]*nz) >> 15;
+
+        heading_map.u[i] = (uint16_t)(bam_atan2(z, x) + BAM_HALF);
+
+        if (y > Q15_ONE - 1) y = Q15_ONE - 1;
+        if (y < -Q15_ONE)    y = -Q15_ONE;
+
+        int ty = fx_row_lut[(y + Q15_ONE) >> ROW_LUT_SHIFT];
+        while (ty < th - 1 && y >= fx_row_start[ty + 1])
+            ty++;
+        heading_map.ty[i] = ty;
+    }
+
+    heading_map.pitch = pitch;
+    heading_map.yaw = yaw;
+    heading_map.valid = 1;
+}
+
+#else
+
+static void heading_map_build(float pitch, float yaw)
+{
+    const int th = navball_tex.height;
+
+    // Rx(pitch) * Rz(yaw), Ry(roll) comes later as a U shift
+    float m[9];
+    navball_rotation_matrix(m, pitch, 0, yaw);
+
+    for (int i = 0; i < navball_cache.count; i++) {
+        float nx = navball_cache.nx[i];
+        float ny = navball_cache.ny[i];
+        float nz = navball_cache.nz[i];
+
+        float x = m[0]*nx + m[1]*ny + m[2]*nz;
+        float y = m[3]*nx + m[4]*ny + m[5]*nz;
+        float z = m[6]*nx + m[7]*ny + m[8]*nz;
+
+        float u = fast_atan2f(z, x) * (float)(1.0 / (2 * PI)) + 0.5f;
+        heading_map.u[i] = (uint16_t)(int32_t)(u * 65536.0f);
+
+        int ty = (int)((fast_asinf(y) * (float)(1.0 / PI) + 0.5f) * th);
+        if (ty < 0) ty = 0;
+        if (ty >= th) ty = th - 1;
+        heading_map.ty[i] = ty;
+    }
+
+    heading_map.pitch = table_index(pitch);
+    heading_map.yaw = table_index(yaw);
+    heading_map.valid = 1;
+}
+
+#endif
+
+void draw_navball_heading(float pitch_deg, float roll_deg, float yaw_deg)
+{
+    if (navball_cache.count == 0)
+        horizon_init();
+
+#if defined(HORIZON_FIXED_POINT)
+    uint16_t pitch = (uint16_t)(int32_t)(pitch_deg * (65536.0f / 360.0f));
+    uint16_t yaw   = (uint16_t)(int32_t)(yaw_deg   * (65536.0f / 360.0f));
+    uint16_t shift = (uint16_t)(int32_t)(roll_deg  * (65536.0f / 360.0f));
+
+    if (!heading_map.valid || pitch != heading_map.pitch || yaw != heading_map.yaw)
+        heading_map_build(pitch, yaw);
+#else
+    float pitch = pitch_deg * (PI / 180.0f);
+    float roll  = roll_deg  * (PI / 180.0f);
+    float yaw   = yaw_deg   * (PI / 180.0f);
+
+    if (!heading_map.valid || table_index(pitch) != heading_map.pitch ||
+        table_index(yaw) != heading_map.yaw)
+        heading_map_build(pitch, yaw);
+
+    // The angle draw_navball()'s table Ry(roll) actually turns by
+    float turn = atan2f(fsin(roll), fcos(roll));
+    uint16_t shift = (uint16_t)(int32_t)lrintf(turn * (float)(65536.0 / (2 * PI)));
+#endif
+
+    // Ry(roll) turns the longitude back by the roll, nothing else
+    const int tw = navball_tex.width;
+
+    for (int i = 0; i < navball_cache.count; i++) {
+        uint32_t u = (uint16_t)(heading_map.u[i] - shift);
+        int tx = (u * tw) >> 16;
+
+        navball_put_texel(i, texture_index(tx, heading_map.ty[i], tw));
+    }
+}
+
+// checked is a constant at both call sites, one of the loops drops the bounds checks
+static inline __attribute__((always_inline))
+void fb_circle_points(int rad, int X0, int Y0, uint16_t color, const int checked)
+{
 	int x = 0;
 	int y = rad;
 	int d = 3-2*rad;
 
+	void (*const plot)(int, int, uint16_t) = checked ? fb_set_pixel : fb_put_pixel;
+
 	while(x<=y){
-		fb_set_pixel(X0 + x, Y0 + y, color);
-		fb_set_pixel(X0 - x, Y0 + y, color);
-		fb_set_pixel(X0 + x, Y0 - y, color);
-		fb_set_pixel(X0 - x, Y0 - y, color);
+		plot(X0 + x, Y0 + y, color);
+		plot(X0 - x, Y0 + y, color);
+		plot(X0 + x, Y0 - y, color);
+		plot(X0 - x, Y0 - y, color);
 
-		fb_set_pixel(X0 + y, Y0 + x, color);
-		fb_set_pixel(X0 - y, Y0 + x, color);
-		fb_set_pixel(X0 + y, Y0 - x, color);
-		fb_set_pixel(X0 - y, Y0 - x, color);
+		plot(X0 + y, Y0 + x, color);
+		plot(X0 - y, Y0 + x, color);
+		plot(X0 + y, Y0 - x, color);
+		plot(X0 - y, Y0 - x, color);
 
 		if(d < 0){
 			d+=4*x+6;
@@ -325,6 +851,16 @@ void framebuffer_draw_circle(uint8_t rad,
 	}
 }
 
+void framebuffer_draw_circle(uint8_t rad, 
+                             uint16_t X0, uint16_t Y0, 
+                             uint16_t color){
+	// The navball rim always fits, bounds are checked once for the circle
+	if (X0 >= rad && X0 + rad < FB_WIDTH && Y0 >= rad && Y0 + rad < FB_HEIGHT)
+		fb_circle_points(rad, X0, Y0, color, 0);
+	else
+		fb_circle_points(rad, X0, Y0, color, 1);
+}
+
 
 
 /*
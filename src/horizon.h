@@ -2,12 +2,21 @@
 #define __HORIZON_H_
 
 #include "st7735s.h"
+#include "texture.h"
 
 #define TABLE_SIZE          630
 #define MAX_NAVBALL_POINTS  500
 
 #define COLOR565_GRAY   0x8080
 #define COLOR565_BLACK  0x0000
+#define COLOR565_GREEN  0x07E0
+
+/**
+ * Framebuffer pixels are RGB565 in panel byte order (big endian), so
+ * frames go to the panel untouched. FB_COLOR() converts a COLOR565_*
+ * constant at compile time; textures are converted when generated.
+ */
+#define FB_COLOR(c)     ((uint16_t)((((c) & 0xFF) << 8) | (((c) >> 8) & 0xFF)))
 
 #define cx      64
 #define cy      80
@@ -16,10 +25,18 @@
 #define FB_WIDTH   128
 #define FB_HEIGHT  160
 
+// Upper bound of pixels inside the navball disc (bounding box of the circle)
+#define NAVBALL_MAX_PIXELS  ((2 * radius + 1) * (2 * radius + 1))
+
 #define DEG_TO_RAD  0.017453292519943295
 #define PI		    3.141592653589793238
 #define STEP_RAD    (2 * PI / TABLE_SIZE)
 
+typedef struct {
+    int x0, y0;
+    int x1, y1;     // inclusive
+} fb_rect_t;
+
 extern const float sin_table[TABLE_SIZE];
 extern const float cos_table[TABLE_SIZE];
 
@@ -27,12 +44,82 @@ float fsin(float rad);
 
 float fcos(float rad);
 
+/**
+ * Build the attitude independent per-pixel sphere normal cache.
+ * Called once at startup, draw_navball() falls back to it lazily.
+ */
+void horizon_init(void);
+
+/**
+ * Sample tex from now on (NULL: the built-in texture, also the default).
+ * The texture must stay mapped while it is in use.
+ */
+void horizon_set_texture(const texture_t *tex);
+
+/**
+ * Rotate a single sphere point (reference path, table lookups per call)
+ */
+void rotate_vec(float *x, float *y, float *z,
+                float pitch, float roll, float yaw);
+
+/**
+ * Build the row-major 3x3 matrix equivalent to rotate_vec()
+ */
+void navball_rotation_matrix(float m[9],
+                             float pitch, float roll, float yaw);
+
+/**
+ * Number of framebuffer pixels covered by the navball disc
+ */
+int horizon_navball_pixels(void);
+
+/**
+ * Fill the framebuffer, color in panel byte order (FB_COLOR())
+ */
 void fb_clear(uint16_t color);
 
 uint16_t* horizon_get_framebuffer(void);
 
+/**
+ * Render into target from now on. Changes are tracked against prev,
+ * the frame target replaces (NULL: target itself, single buffering).
+ * Target must already hold an earlier frame: only the navball disc and
+ * the overlays are redrawn.
+ */
+void horizon_set_framebuffer(uint16_t *target, const uint16_t *prev);
+
+/**
+ * Bounding box of the pixels drawn since the previous call that differ
+ * from the previous frame. Returns 0 (rect untouched) when unchanged.
+ */
+int horizon_take_dirty(fb_rect_t *rect);
+
 void draw_navball(float pitch_deg, float roll_deg, float yaw_deg);
 
+/**
+ * Same picture as draw_navball(), faster when only roll changes. The
+ * last rotation of Ry(roll) * Rx(pitch) * Rz(yaw) turns the ball about
+ * the texture pole (the heading scale) and only shifts the texture U,
+ * so the disc UV map is cached per pitch/yaw and a roll-only change
+ * just resamples it. Matches draw_navball() to within a texel of U at
+ * texel boundaries, where the atan2 approximation rounds differently.
+ */
+void draw_navball_heading(float pitch_deg, float roll_deg, float yaw_deg);
+
+#if defined(HORIZON_FIXED_POINT)
+/**
+ * Integer pipeline, angles in BAM (65536 per turn, see fixed_math.h).
+ * draw_navball() forwards here in HORIZON_FIXED_POINT builds.
+ */
+void navball_rotation_matrix_q15(int32_t m[9],
+                                 uint16_t pitch, uint16_t roll, uint16_t yaw);
+
+void draw_navball_bam(uint16_t pitch, uint16_t roll, uint16_t yaw);
+#endif
+
+/**
+ * Midpoint circle outline, color in panel byte order (FB_COLOR())
+ */
 void framebuffer_draw_circle(uint8_t rad, 
                              uint16_t X0, uint16_t Y0, 
                              uint16_t color);
@@ -1,33 +1,66 @@
 #include "st7735s.h"
 #include "gpio.h"
 #include "horizon.h"
+#include "frame_queue.h"
+#include "frame_stats.h"
+#include "uart.h"
+#include "attitude_filter.h"
+#include "frame_pacer.h"
+#include "telemetry_log.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <malloc.h>
 #include <pthread.h>
 #include <stdint.h>
-#include <fcntl.h>
-#include <termios.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <getopt.h>
+#include <stdlib.h>
+#include <stdatomic.h>
 
-#define PACKET_SIZE     7
-#define START_BYTE      0xAA
+// Newest attitude, written by the UART (or demo) thread only
+static attitude_box_t attitude_box;
 
-typedef struct __attribute__((packed)){
-    uint8_t start_byte;
-    int16_t pitch;
-    int16_t roll;
-    int16_t yaw;
-}uart_packet;
+// UART side wakes the idle renderer through it
+static frame_pacer_t pacer;
 
-static uint8_t receive_buffer[PACKET_SIZE];
-static int state = 0;
-static int idx = 0;
-static uart_packet uartMsg;
+static const char *uart_path = "/dev/ttyUSB0";
+static uart_parser_t uart_parser;
+static uart_protocol_t uart_protocol = UART_PROTOCOL_LEGACY;
 
-pthread_mutex_t uart_packet_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const char *record_path = NULL;
+static const char *replay_path = NULL;
+static int replay_max_speed = 0;
+
+// Last attitude_box sequence the renderer has picked up
+static atomic_uint consumed_seq;
+static atomic_int renderer_ready;
+
+// Sender timestamps in a replayed log are from another day
+static int sender_time_valid = 1;
+
+// End of the replayed log. The main thread owns the stats file and does
+// the final write, frame_stats_write() must not run on two threads.
+static pthread_mutex_t replay_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t replay_cond;
+static int replay_done = 0;
+
+static const char *stats_path = "/run/lcd_app.stats";
+
+// NULL: the texture compiled into the binary
+static const char *texture_path = NULL;
+
+// Roll about the navball pole as a texture shift, see draw_navball_heading()
+static int heading_scroll = 0;
+
+static void write_link_stats(FILE *f)
+{
+    const uart_counters_t *c = &uart_parser.counters;
+
+    fprintf(f, "\nuart frames %u corrupt %u dropped %u duplicated %u skipped %u\n",
+            c->frames, c->corrupt, c->dropped, c->duplicated, c->skipped);
+}
 
 uint64_t get_ticks_us()
 {
@@ -36,56 +69,105 @@ uint64_t get_ticks_us()
     return (uint64_t)ts.tv_sec * 1000000ULL + (ts.tv_nsec / 1000);
 }
 
+/**
+ * Sleeps up to timeout_us, returns 1 as soon as the replay has ended
+ */
+static int wait_replay_done(uint64_t timeout_us)
+{
+    uint64_t due = get_ticks_us() + timeout_us;
+    struct timespec ts = {
+        .tv_sec = due / 1000000,
+        .tv_nsec = (due % 1000000) * 1000,
+    };
+
+    pthread_mutex_lock(&replay_lock);
+    while (!replay_done && pthread_cond_timedwait(&replay_cond, &replay_lock, &ts) == 0)
+        ;
+    int done = replay_done;
+    pthread_mutex_unlock(&replay_lock);
+
+    return done;
+}
+
+// Synthetic attitude sweep in place of the UART, for running without a
+// flight computer attached
+void *demo_main(void *arguments){
+    while (1) {
+        double t = get_ticks_us() / 1000000.0;
+        attitude_t a;
+
+        a.pitch = 60 * sin(t * 0.7);
+        a.roll = 45 * sin(t * 0.3);
+        a.yaw = fmod(t * 20.0, 360);
+        a.rx_us = get_ticks_us();
+        attitude_publish(&attitude_box, &a);
+        frame_pacer_notify(&pacer);
+
+        usleep(10000);
+    }
+
+    return NULL;
+}
+
+// Parse received bytes, only the newest packet is of interest to the
+// renderer. Returns 1 if one was published.
+static int feed_uart_bytes(const uint8_t *buf, size_t n, uint64_t rx_us)
+{
+    static attitude_t latest;
+
+    latest.rx_us = rx_us;
+    if (!uart_parse(&uart_parser, buf, n, &latest))
+        return 0;
+
+    if (!sender_time_valid)
+        latest.flags &= ~ATTITUDE_SENDER_TIME;
+
+    attitude_publish(&attitude_box, &latest);
+    frame_pacer_notify(&pacer);
+    return 1;
+}
+
 void *uart_main(void *arguments){
-    int fd = open("/dev/ttyUSB0", O_RDWR | O_NOCTTY);
+    int fd = uart_open(uart_path);
     if (fd < 0) {
         printf("Unable to open UART com port...\n");
         return NULL;
     }
 
-    // configure UART
-    struct termios tty;
-    tcgetattr(fd, &tty);
-    cfsetospeed(&tty, B115200);
-    cfsetispeed(&tty, B115200);
-    tty.c_cflag = CS8 | CREAD | CLOCAL;
-    tty.c_lflag = 0;
-    tty.c_iflag = 0;
-    tty.c_oflag = 0;
-    tcsetattr(fd, TCSANOW, &tty);
+    uart_parser_init(&uart_parser, uart_protocol);
+
+    telemetry_log_t log = { 0 };
+    if (record_path && telemetry_log_create(&log, record_path, get_ticks_us())) {
+        printf("Unable to create telemetry log %s...\n", record_path);
+        record_path = NULL;
+    }
 
-    uint8_t byte;
+    uint8_t buf[UART_READ_SIZE];
+    uint64_t flushed_us = 0;
 
     while (1) {
-        int n = read(fd, &byte, 1);
+        // Everything buffered in one syscall
+        ssize_t n = read(fd, buf, sizeof(buf));
         if (n <= 0) continue;
 
-        switch (state) {
-        case 0:
-            /**
-             * Check if the first received byte is the starting byte (0xAA)
-             * If it is, switch state to 1 so that every reading cycle it processes
-             * The remaining bytes in the packet. Once index == PACKET_SIZE (7 bytes)
-             * Copy from receive buffer into mutex packet and reset.
-             */
-            if (byte == START_BYTE) {
-                receive_buffer[0] = byte;
-                idx = 1;
-                state = 1;
-            }
-            break;
+        uint64_t rx_us = get_ticks_us();
 
-        case 1:
-            receive_buffer[idx++] = byte;
+        if (record_path) {
+            // At most a second of capture lost if we get killed
+            int err = telemetry_log_write(&log, rx_us, buf, n);
+            if (!err && rx_us - flushed_us >= 1000000) {
+                err = telemetry_log_flush(&log);
+                flushed_us = rx_us;
+            }
 
-            if (idx == PACKET_SIZE) {
-                pthread_mutex_lock(&uart_packet_mutex);
-                memcpy(&uartMsg, receive_buffer, PACKET_SIZE);
-                pthread_mutex_unlock(&uart_packet_mutex);
-                state = 0;
+            if (err) {
+                printf("Telemetry log write failed, recording stopped...\n");
+                telemetry_log_close(&log);
+                record_path = NULL;
             }
-            break;
         }
+
+        feed_uart_bytes(buf, n, rx_us);
     }
 
     close(fd);
@@ -93,45 +175,396 @@ void *uart_main(void *arguments){
     return NULL;
 }
 
+/**
+ * Feed a recorded (or synthetic) telemetry log through the UART parser,
+ * at the recorded pace or as fast as the renderer takes the packets.
+ * At the end of the log the main thread writes the stats and exits.
+ */
+void *replay_main(void *arguments){
+    telemetry_log_t log;
+    if (telemetry_log_open(&log, replay_path)) {
+        printf("Unable to open telemetry log %s...\n", replay_path);
+        exit(1);
+    }
+
+    uart_parser_init(&uart_parser, uart_protocol);
+    sender_time_valid = 0;
+
+    // Panel init takes a while, the clock starts with the first frame
+    while (!atomic_load(&renderer_ready))
+        usleep(1000);
+
+    uint8_t buf[TELEMETRY_LOG_MAX_CHUNK];
+    uint64_t start_us = get_ticks_us();
+    uint64_t t_us;
+    unsigned packets = 0;
+    int n;
+
+    while ((n = telemetry_log_read(&log, &t_us, buf, sizeof(buf))) > 0) {
+        if (!replay_max_speed) {
+            uint64_t due = start_us + t_us;
+            struct timespec ts = {
+                .tv_sec = due / 1000000,
+                .tv_nsec = (due % 1000000) * 1000,
+            };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+
+        if (!feed_uart_bytes(buf, n, get_ticks_us()))
+            continue;
+        packets++;
+
+        // Max speed: every packet is rendered, none overtaken by the next
+        if (replay_max_speed) {
+            unsigned seq = atomic_load(&attitude_box.seq);
+            while (atomic_load(&consumed_seq) != seq)
+                usleep(50);
+        }
+    }
+
+    if (n < 0)
+        printf("Telemetry log %s is damaged...\n", replay_path);
+
+    double secs = (get_ticks_us() - start_us) / 1000000.0;
+    uint64_t frames = atomic_load(&frame_stats[STAGE_RENDER].head);
+
+    // Let the last frame reach the panel
+    usleep(100000);
+
+    printf("Replay done: %u packets, %llu frames in %.3f s (%.1f fps)\n",
+           packets, (unsigned long long)frames, secs, frames / secs);
+
+    telemetry_log_close(&log);
+
+    pthread_mutex_lock(&replay_lock);
+    replay_done = 1;
+    pthread_cond_signal(&replay_cond);
+    pthread_mutex_unlock(&replay_lock);
+
+    return NULL;
+}
+
+static st7735s_t horizon_lcd;
+static frame_queue_t frame_queue;
+
+static const char *backend_name = "spidev";
+static attitude_mode_t motion_mode = ATTITUDE_HOLD;
+static int target_fps = 60;
+static int latency_mode = 0;
+static int demo_mode = 0;
+
+// Rotation below which no pixel visibly moves: half a pixel at the
+// centre of the disc, where the sphere surface moves fastest
+#define VISIBLE_ANGLE_RAD   (0.5f / radius)
+
+#define STATS_INTERVAL_US   5000000
+
+static void print_tx_stats(uint64_t frames, uint64_t elapsed_us,
+                           const st7735s_stats_t *now,
+                           const st7735s_stats_t *last)
+{
+    if (!frames)
+        return;
+
+    printf("[%s] %.1f fps, %.0f bytes/frame, %.1f cmds/frame, "
+           "%.1f msgs/frame, %.1f windows/frame\n",
+           horizon_lcd.backend->name,
+           frames * 1000000.0 / elapsed_us,
+           (double)(now->bytes - last->bytes) / frames,
+           (double)(now->commands - last->commands) / frames,
+           (double)(now->messages - last->messages) / frames,
+           (double)(now->windows - last->windows) / frames);
+}
+
+/**
+ * Staleness of the attitude a frame shows, taken once the frame is on
+ * the wire. Sender timestamps are compared against this host's
+ * CLOCK_MONOTONIC, which is only meaningful if the sender stamps with
+ * the same clock (a fake sender on the same box) or syncs to it.
+ */
+static void trace_latency(const attitude_t *src, uint64_t wire_us)
+{
+    if (!src->rx_us)
+        return;
+
+    frame_stats_record(STAGE_RX_TO_WIRE, wire_us - src->rx_us);
+
+    if (src->flags & ATTITUDE_SENDER_TIME) {
+        int32_t d = (uint32_t)wire_us - src->sender_us;
+        if (d >= 0)
+            frame_stats_record(STAGE_SENDER_TO_WIRE, d);
+    }
+}
+
+void *spi_tx_main(void *arguments){
+    st7735s_stats_t last = horizon_lcd.stats;
+    uint64_t last_us = get_ticks_us();
+    uint64_t frames = 0;
+
+    while(1){
+        // Frame N goes out on the wire while frame N+1 is being rendered
+        frame_t *frame = frame_queue_take(&frame_queue);
+
+        uint64_t t0 = get_ticks_us();
+        st7735s_push_framebuffer_diff(&horizon_lcd, frame->pixels,
+                                      frame->dirty.y0, frame->dirty.y1);
+        uint64_t wire_us = get_ticks_us();
+        frame_stats_record(STAGE_PUSH, wire_us - t0);
+
+        trace_latency(&frame->source, wire_us);
+
+        frame_queue_release(&frame_queue);
+        frames++;
+
+        uint64_t now_us = get_ticks_us();
+        if (now_us - last_us >= STATS_INTERVAL_US) {
+            print_tx_stats(frames, now_us - last_us, &horizon_lcd.stats, &last);
+            if (latency_mode) {
+                frame_stats_print_histogram(stdout, STAGE_RX_TO_WIRE);
+                frame_stats_print_histogram(stdout, STAGE_SENDER_TO_WIRE);
+            }
+            last = horizon_lcd.stats;
+            last_us = now_us;
+            frames = 0;
+        }
+    }
+
+    return NULL;
+}
+
 void *lcd_main(void *arguments){
-    st7735s_t horizon_lcd;
+    st7735s_backend_t *backend = st7735s_backend_open(backend_name,
+                                                      "/dev/spidev0.0",
+                                                      24,      // DC GPIO
+                                                      25);     // RESET GPIO
 
-    if (st7735s_init(&horizon_lcd,
-                    "/dev/spidev0.0",
-                    24,      // DC GPIO
-                    25)) {    // RESET GPIO
+    if (st7735s_init(&horizon_lcd, backend)) {
         printf("LCD init failed...\n");
         return NULL;
     }
 
     st7735s_fill_screen(&horizon_lcd, 0x0000);
+    horizon_init();
+
+    if (frame_queue_init(&frame_queue, FB_WIDTH, FB_HEIGHT)) {
+        printf("Frame queue init failed...\n");
+        return NULL;
+    }
+
+    pthread_t spi_tx_thread;
+
+    if(pthread_create(&spi_tx_thread, NULL, spi_tx_main, NULL) != 0){
+        printf("Unable to create SPI transmit thread...\n");
+        return NULL;
+    }
+
+    pthread_detach(spi_tx_thread);
+
+    attitude_filter_t motion;
+    attitude_filter_init(&motion, motion_mode);
+    unsigned last_seq = 0;
 
-    int16_t pitch, roll, yaw;
+    float pitch = 0, roll = 0, yaw = 0;
+    quat_t shown = { 1, 0, 0, 0 };
+    int have_frame = 0;
+
+    atomic_store(&renderer_ready, 1);
 
     while(1){
-        pthread_mutex_lock(&uart_packet_mutex);
-        pitch = uartMsg.pitch;
-        roll = uartMsg.roll;
-        yaw = uartMsg.yaw;
-        pthread_mutex_unlock(&uart_packet_mutex);
+        frame_pacer_wait_frame(&pacer);
+
+        uint64_t t0 = get_ticks_us();
+
+        attitude_t att;
+        unsigned seq = attitude_read(&attitude_box, &att);
+        if (seq != last_seq) {
+            attitude_filter_push(&motion, &att);
+            last_seq = seq;
+            atomic_store(&consumed_seq, seq);
+        }
+
+        // Attitude at this instant, not at the last packet
+        attitude_filter_sample(&motion, t0, &pitch, &roll, &yaw);
+
+        // Nothing would visibly change: sleep until the next packet, or
+        // poll at frame rate while the filter is still moving
+        quat_t q = quat_from_euler(pitch, roll, yaw);
+        if (have_frame && quat_angle(&q, &shown) < VISIBLE_ANGLE_RAD) {
+            if (attitude_filter_settled(&motion, t0))
+                frame_pacer_wait_event(&pacer, -1);
+            else if (!pacer.period_ns)
+                frame_pacer_wait_event(&pacer, 1);
+            continue;
+        }
+
+        shown = q;
+        have_frame = 1;
+
+        uint64_t t1 = get_ticks_us();
+        frame_stats_record(STAGE_ACQUIRE, t1 - t0);
+
+        const uint16_t *prev;
+        frame_t *frame = frame_queue_render_target(&frame_queue, &prev);
+        horizon_set_framebuffer(frame->pixels, prev);
+
+        // Forwards to draw_navball_bam() in HORIZON_FIXED_POINT builds
+        if (heading_scroll)
+            draw_navball_heading(pitch, roll, yaw);
+        else
+            draw_navball(pitch, roll, yaw);
+        uint64_t t2 = get_ticks_us();
+        frame_stats_record(STAGE_RENDER, t2 - t1);
 
-        // int pitch = 300 * sin(get_ticks_us() / 10.0);
-        // int roll = 0;//4 * fsin(HAL_GetTick() / 12.0);
-        // int yaw = fmod(get_ticks_us() / 20.0, 360); 
+        framebuffer_draw_circle(radius+1, cx, cy, FB_COLOR(COLOR565_GREEN));
+        frame_stats_record(STAGE_OVERLAY, get_ticks_us() - t2);
 
-        draw_navball(pitch, roll, yaw);
-        framebuffer_draw_circle(radius+1, cx, cy, 0x07E0);
-        st7735s_push_framebuffer(&horizon_lcd, horizon_get_framebuffer(), FB_WIDTH, FB_HEIGHT);
+        // Identical frames are never handed to the transmit thread
+        fb_rect_t dirty;
+        if (horizon_take_dirty(&dirty)) {
+            frame->source = motion.latest;
+            frame_queue_publish(&frame_queue, &dirty);
+        }
     }
 
     return NULL;
 }
 
-int main() {
+static void usage(const char *prog)
+{
+    printf("Usage: %s [--backend spidev|virtual|sim|null] [--demo] "
+           "[--stats PATH] [--protocol legacy|framed]\n"
+           "       [--motion hold|extrapolate|interpolate] [--fps N (0: uncapped)]\n"
+           "       [--uart PATH] [--latency] [--record LOG]\n"
+           "       [--replay LOG] [--replay-speed realtime|max] [--texture FILE]\n"
+           "       [--heading-scroll]\n"
+           "\n"
+           "--heading-scroll draws the same ball from a cached map, roll about\n"
+           "the pole is a texture shift. Faster when mostly roll changes.\n",
+           prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option long_options[] = {
+        { "backend", required_argument, NULL, 'b' },
+        { "demo",    no_argument,       NULL, 'd' },
+        { "stats",   required_argument, NULL, 's' },
+        { "protocol", required_argument, NULL, 'p' },
+        { "motion",  required_argument, NULL, 'm' },
+        { "fps",     required_argument, NULL, 'f' },
+        { "uart",    required_argument, NULL, 'u' },
+        { "latency", no_argument,       NULL, 'l' },
+        { "record",  required_argument, NULL, 'r' },
+        { "replay",  required_argument, NULL, 'R' },
+        { "replay-speed", required_argument, NULL, 'S' },
+        { "texture", required_argument, NULL, 't' },
+        { "heading-scroll", no_argument, NULL, 'H' },
+        { "help",    no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "b:ds:p:m:f:u:lr:R:S:t:Hh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'b':
+            backend_name = optarg;
+            break;
+        case 'd':
+            demo_mode = 1;
+            break;
+        case 's':
+            stats_path = optarg;
+            break;
+        case 'p':
+            if (!strcmp(optarg, "framed")) {
+                uart_protocol = UART_PROTOCOL_FRAMED;
+            } else if (!strcmp(optarg, "legacy")) {
+                uart_protocol = UART_PROTOCOL_LEGACY;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'm':
+            if (!strcmp(optarg, "hold")) {
+                motion_mode = ATTITUDE_HOLD;
+            } else if (!strcmp(optarg, "extrapolate")) {
+                motion_mode = ATTITUDE_EXTRAPOLATE;
+            } else if (!strcmp(optarg, "interpolate")) {
+                motion_mode = ATTITUDE_INTERPOLATE;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'f':
+            target_fps = atoi(optarg);
+            break;
+        case 'u':
+            uart_path = optarg;
+            break;
+        case 'l':
+            latency_mode = 1;
+            break;
+        case 'r':
+            record_path = optarg;
+            break;
+        case 'R':
+            replay_path = optarg;
+            break;
+        case 'S':
+            if (!strcmp(optarg, "max")) {
+                replay_max_speed = 1;
+            } else if (!strcmp(optarg, "realtime")) {
+                replay_max_speed = 0;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 't':
+            texture_path = optarg;
+            break;
+        case 'H':
+            heading_scroll = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    // Stays mapped for the life of the process
+    static texture_t texture;
+    if (texture_path) {
+        if (texture_open(&texture, texture_path)) {
+            printf("Unable to map texture %s...\n", texture_path);
+            return 1;
+        }
+        horizon_set_texture(&texture);
+    }
+
+    if (frame_pacer_init(&pacer, target_fps)) {
+        printf("Frame pacer init failed...\n");
+        return 1;
+    }
+
+    // Stats interval timed on the same clock as get_ticks_us()
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&replay_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
     pthread_t uart_thread;
     pthread_t lcd_thread;
 
-    if(pthread_create(&uart_thread, NULL, uart_main, NULL) != 0){
+    void *(*source_main)(void *) = uart_main;
+    if (demo_mode)
+        source_main = demo_main;
+    else if (replay_path)
+        source_main = replay_main;
+
+    if(pthread_create(&uart_thread, NULL, source_main, NULL) != 0){
         printf("Unable to create UART thread...\n");
         return 0;
     }
@@ -144,17 +577,30 @@ int main() {
     }
 
     pthread_detach(lcd_thread);
-    
-    int led_gpio = 26;
-    gpio_request_output(led_gpio);
-
-    while(1){  
-        gpio_set(led_gpio, 1);
-        printf("Led should be on...\n");
-        sleep(5);
-        gpio_set(led_gpio, 0);
-        printf("Led should be off...\n");
-        sleep(5);
+
+    // No GPIO chip to blink on without the real panel
+    int led_gpio = -1;
+    if (!strcmp(backend_name, "spidev")) {
+        led_gpio = 26;
+        gpio_request_output(led_gpio);
+    }
+
+    // Heartbeat LED, and the stage timings for anyone watching the file.
+    // A finished replay gets one last write, then the program exits.
+    int led = 0;
+    int stats_failed = 0;
+    int done = 0;
+    while(1){
+        if (led_gpio >= 0)
+            gpio_set(led_gpio, led ^= 1);
+
+        if (frame_stats_write(stats_path, write_link_stats) < 0 && !stats_failed++)
+            printf("Unable to write stats to %s...\n", stats_path);
+
+        if (done)
+            break;
+
+        done = wait_replay_done(STATS_INTERVAL_US);
     }
 
     return 0;
@@ -0,0 +1,28 @@
+#ifndef __NAVBALL_TEXTURE_H_
+#define __NAVBALL_TEXTURE_H_
+
+#include <stdint.h>
+
+/**
+ * Navball texture, 8 bit palette indices into RGB565 colours stored in
+ * panel byte order (see FB_COLOR() in horizon.h). Generated at build
+ * time from the PNGs in resources/ by tools/texture_convert, in the
+ * layout of texture_layout.h. Size is picked by the Makefile
+ * (NAVBALL_TEXTURE_SIZE), both sides must be multiples of the tile.
+ */
+
+#ifndef NAVBALL_TEXTURE_WIDTH
+#define NAVBALL_TEXTURE_WIDTH   256
+#endif
+
+#ifndef NAVBALL_TEXTURE_HEIGHT
+#define NAVBALL_TEXTURE_HEIGHT  128
+#endif
+
+#define NAVBALL_PALETTE_SIZE    256
+
+extern const uint16_t navball_palette[NAVBALL_PALETTE_SIZE];
+
+extern const uint8_t navball_texture[NAVBALL_TEXTURE_HEIGHT*NAVBALL_TEXTURE_WIDTH];
+
+#endif
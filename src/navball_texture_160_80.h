@@ -1,12 +0,0 @@
-#ifndef __NAVBALL_TEXTURE_160_80_
-#define __NAVBALL_TEXTURE_160_80_
-
-#include <stdint.h>
-
-#define NAVBALL_TEXTURE_160_80_HEIGHT 80
-#define NAVBALL_TEXTURE_160_80_WIDTH 160
-
-// array size is 25600
-extern const uint16_t navball_texture_160_80[NAVBALL_TEXTURE_160_80_HEIGHT*NAVBALL_TEXTURE_160_80_WIDTH];
-
-#endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef __NAVBALL_UV_H_
+#define __NAVBALL_UV_H_
+
+#include "horizon.h"
+#include <math.h>
+
+/**
+ * Sphere -> texture mapping kernels used by draw_navball().
+ *
+ * One texel of the 256x128 texture spans 2*PI/256 = 0.0245 rad (0.039 rad
+ * for 160x80). fast_atan2f() stays within 2.1e-4 rad and fast_asinf()
+ * within 6.8e-5 rad of libm, so the fast path lands on the same texel as
+ * navball_uv_texel_ref() except right at a texel boundary, where it is
+ * off by at most one.
+ */
+
+// atan2 with octant reduction and a 7th order odd polynomial on [0, 1]
+static inline float fast_atan2f(float y, float x)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = ax > ay ? ax : ay;
+    float mn = ax > ay ? ay : ax;
+
+    if (mx == 0.0f)
+        return 0.0f;
+
+    float a = mn / mx;
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+
+    if (ay > ax) r = (float)(PI / 2) - r;
+    if (x < 0)   r = (float)PI - r;
+    if (y < 0)   r = -r;
+
+    return r;
+}
+
+// asin after Abramowitz & Stegun 4.4.45
+static inline float fast_asinf(float x)
+{
+    float ax = fabsf(x);
+    if (ax > 1.0f) ax = 1.0f;
+
+    float p = ((-0.0187293f * ax + 0.0742610f) * ax - 0.2121144f) * ax + 1.5707288f;
+    float r = (float)(PI / 2) - sqrtf(1.0f - ax) * p;
+
+    return x < 0 ? -r : r;
+}
+
+static inline void navball_uv_clamp(float u, float v,
+                                    int tex_w, int tex_h,
+                                    int *tx, int *ty)
+{
+    int x = (int)(u * tex_w);
+    int y = (int)(v * tex_h);
+
+    if (x < 0) x = 0;
+    if (x >= tex_w) x = tex_w - 1;
+    if (y < 0) y = 0;
+    if (y >= tex_h) y = tex_h - 1;
+
+    *tx = x;
+    *ty = y;
+}
+
+/**
+ * Map a rotated unit sphere point to texel coordinates
+ */
+static inline void navball_uv_texel(float x, float y, float z,
+                                    int tex_w, int tex_h,
+                                    int *tx, int *ty)
+{
+    float u = fast_atan2f(z, x) * (float)(1.0 / (2 * PI)) + 0.5f;
+    float v = fast_asinf(y) * (float)(1.0 / PI) + 0.5f;
+
+    navball_uv_clamp(u, v, tex_w, tex_h, tx, ty);
+}
+
+/**
+ * Reference mapping through libm, for accuracy comparisons
+ */
+static inline void navball_uv_texel_ref(float x, float y, float z,
+                                        int tex_w, int tex_h,
+                                        int *tx, int *ty)
+{
+    float u = (atan2f(z, x) + PI) / (2.0f * PI);
+    float v = (asinf(y) / PI) + 0.5f;
+
+    navball_uv_clamp(u, v, tex_w, tex_h, tx, ty);
+}
+
+#endif
@@ -25,6 +25,16 @@ int spi_init(spi_device_t *dev,
     dev->speed_hz = speed_hz;
     dev->bits_per_word = bits_per_word;
     dev->delay_us = 0;
+    dev->bufsiz = SPI_DEFAULT_BUFSIZ;
+
+    // spidev rejects messages larger than its bounce buffer
+    FILE *f = fopen(SPI_BUFSIZ_PARAM, "r");
+    if (f) {
+        unsigned int bufsiz;
+        if (fscanf(f, "%u", &bufsiz) == 1 && bufsiz > 0)
+            dev->bufsiz = bufsiz;
+        fclose(f);
+    }
 
     // Mode
     if (ioctl(dev->fd, SPI_IOC_WR_MODE, &dev->mode) == -1) {
@@ -48,57 +58,68 @@ int spi_init(spi_device_t *dev,
     printf("  Mode: %d\n", dev->mode);
     printf("  Speed: %u Hz\n", dev->speed_hz);
     printf("  Bits: %u\n", dev->bits_per_word);
+    printf("  Bufsiz: %u\n", dev->bufsiz);
 
     return 0;
 }
 
-int spi_transfer(spi_device_t *dev,
-                 const uint8_t *tx,
-                 uint8_t *rx,
-                 size_t len)
+static int spi_submit(spi_device_t *dev,
+                      struct spi_ioc_transfer *tr,
+                      size_t count)
 {
-    struct spi_ioc_transfer tr = {
-        .tx_buf = (unsigned long)tx,
-        .rx_buf = (unsigned long)rx,
-        .len = len,
-        .delay_usecs = dev->delay_us,
-        .speed_hz = dev->speed_hz,
-        .bits_per_word = dev->bits_per_word,
-    };
-
-    int ret = ioctl(dev->fd, SPI_IOC_MESSAGE(1), &tr);
+    int ret = ioctl(dev->fd, SPI_IOC_MESSAGE(count), tr);
     if (ret < 1) {
-        perror("SPI: transfer failed");
+        perror("SPI: segment transfer failed");
         return -1;
     }
 
     return 0;
 }
 
-int spi_write(spi_device_t *dev,
-              const uint8_t *tx,
-              size_t len)
+int spi_write_segments(spi_device_t *dev,
+                       const spi_segment_t *seg,
+                       size_t n)
 {
-    return spi_transfer(dev, tx, NULL, len);
-}
-
-#define CHUNK 4096
-
-void spi_write_chunked(spi_device_t *dev, const uint8_t *data, size_t len) {
-    size_t pos = 0;
-
-    while (pos < len) {
-        size_t n = len - pos;
-        if (n > CHUNK) n = CHUNK;
-
-        int ret = write(dev->fd, data + pos, n);
-        if (ret < 0) {
-            perror("spi write");
-            return;
+    struct spi_ioc_transfer tr[SPI_MAX_SEGMENTS];
+    size_t count = 0;
+    size_t total = 0;
+
+    memset(tr, 0, sizeof(tr));
+
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *buf = seg[i].buf;
+        size_t len = seg[i].len;
+
+        while (len > 0) {
+            // Message full: out of transfers or bounce buffer space
+            if (count == SPI_MAX_SEGMENTS || total == dev->bufsiz) {
+                if (spi_submit(dev, tr, count) < 0)
+                    return -1;
+                memset(tr, 0, count * sizeof(tr[0]));
+                count = 0;
+                total = 0;
+            }
+
+            size_t piece = dev->bufsiz - total;
+            if (piece > len) piece = len;
+
+            tr[count].tx_buf = (unsigned long)buf;
+            tr[count].len = piece;
+            tr[count].delay_usecs = dev->delay_us;
+            tr[count].speed_hz = dev->speed_hz;
+            tr[count].bits_per_word = dev->bits_per_word;
+            count++;
+
+            buf += piece;
+            len -= piece;
+            total += piece;
         }
-
-        pos += n;
     }
+
+    if (count > 0)
+        return spi_submit(dev, tr, count);
+
+    return 0;
 }
 
 void spi_close(spi_device_t *dev)
@@ -10,8 +10,21 @@ typedef struct {
     uint8_t bits_per_word;
     uint32_t speed_hz;
     uint16_t delay_us;
+    uint32_t bufsiz;        // spidev bounce buffer, max bytes per message
 } spi_device_t;
 
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+} spi_segment_t;
+
+// Transfers per SPI_IOC_MESSAGE ioctl
+#define SPI_MAX_SEGMENTS    64
+
+// spidev default when the bufsiz module parameter cannot be read
+#define SPI_DEFAULT_BUFSIZ  4096
+#define SPI_BUFSIZ_PARAM    "/sys/module/spidev/parameters/bufsiz"
+
 /**
  * Initialize SPI device.
  *
@@ -24,26 +37,16 @@ int spi_init(spi_device_t *dev,
              uint8_t bits_per_word);
 
 /**
- * Full duplex transfer
- */
-int spi_transfer(spi_device_t *dev,
-                 const uint8_t *tx,
-                 uint8_t *rx,
-                 size_t len);
-
-/**
- * Simple write (half-duplex)
- */
-int spi_write(spi_device_t *dev,
-              const uint8_t *tx,
-              size_t len);
-
-/**
- * Writing SPI message split into chunks
+ * Write several buffers as SPI_IOC_MESSAGE(n) ioctls, one transfer per
+ * buffer (or piece of one). Each message carries at most dev->bufsiz
+ * bytes and SPI_MAX_SEGMENTS transfers, one ioctl for everything when
+ * spidev.bufsiz is large enough. Chip select stays asserted across the
+ * transfers of a message and is released between messages. The ST7735S
+ * latches every byte on its own, so that only costs the CS gap.
  */
-void spi_write_chunked(spi_device_t *dev, 
-                       const uint8_t *data, 
-                       size_t len);
+int spi_write_segments(spi_device_t *dev,
+                       const spi_segment_t *seg,
+                       size_t n);
 
 /**
  * Close device
@@ -1,8 +1,5 @@
-#include "gpio.h"
 #include "st7735s.h"
-#include "spi.h"
 #include <unistd.h>
-#include <linux/spi/spidev.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,22 +8,51 @@
 // // Internal helpers
 // //
 
-static void write_cmd(st7735s_t *lcd, uint8_t cmd)
+static void set_dc(st7735s_t *lcd, int level)
 {
-    gpio_set(lcd->pin_dc, 0);
-    spi_write_chunked(&lcd->spi, &cmd, 1);
+    if (lcd->dc_level == level)
+        return;
+
+    lcd->backend->set_dc(lcd->backend, level);
+    lcd->dc_level = level;
+    lcd->stats.dc_toggles++;
 }
 
-static void write_data(st7735s_t *lcd, uint8_t data)
+static void write_data_buf(st7735s_t *lcd, uint8_t *buf, size_t len)
 {
-    gpio_set(lcd->pin_dc, 1);
-    spi_write_chunked(&lcd->spi, &data, 1);
+    st7735s_queue_data(lcd, buf, len);
+    st7735s_flush(lcd);
 }
 
-static void write_data_buf(st7735s_t *lcd, uint8_t *buf, size_t len)
+static void queue_segment(st7735s_t *lcd, int dc,
+                          const uint8_t *buf, size_t len)
 {
-    gpio_set(lcd->pin_dc, 1);
-    spi_write_chunked(&lcd->spi, buf, len);
+    st7735s_queue_t *q = &lcd->queue;
+
+    if (q->count == ST7735S_QUEUE_SEGMENTS)
+        st7735s_flush(lcd);
+
+    q->seg[q->count].buf = buf;
+    q->seg[q->count].len = len;
+    q->dc[q->count] = dc;
+    q->count++;
+}
+
+// Copy small command/parameter bytes into the queue's own storage
+static void queue_bytes(st7735s_t *lcd, int dc,
+                        const uint8_t *buf, size_t len)
+{
+    st7735s_queue_t *q = &lcd->queue;
+
+    if (q->used + len > ST7735S_QUEUE_BYTES ||
+        q->count == ST7735S_QUEUE_SEGMENTS)
+        st7735s_flush(lcd);
+
+    uint8_t *dst = &q->bytes[q->used];
+    memcpy(dst, buf, len);
+    q->used += len;
+
+    queue_segment(lcd, dc, dst, len);
 }
 
 //
@@ -67,48 +93,45 @@ static void run_init_sequence(st7735s_t *lcd)
 
         if (count > 0) {
             uint8_t cmd = *p++;
-            write_cmd(lcd, cmd);
-
-            for (int i = 1; i < count; i++)
-                write_data(lcd, *p++);
+            st7735s_queue_cmd(lcd, cmd, p, count - 1);
+            p += count - 1;
         } else {
             // delay
             uint8_t ms = *p++;
+            st7735s_flush(lcd);
             usleep(ms * 1000);
         }
     }
+
+    st7735s_flush(lcd);
 }
 
 //
 // Public API
 //
 
-int st7735s_init(st7735s_t *lcd,
-                 const char *spi_dev,
-                 int gpio_dc,
-                 int gpio_reset)
+int st7735s_init(st7735s_t *lcd, st7735s_backend_t *backend)
 {
     memset(lcd, 0, sizeof(*lcd));
 
-    lcd->pin_dc = gpio_dc;
-    lcd->pin_reset = gpio_reset;
+    if (!backend)
+        return -1;
 
-    gpio_request_output(gpio_dc);
-    gpio_request_output(gpio_reset);
+    lcd->backend = backend;
+    lcd->dc_level = -1;
 
     // Hardware reset pulse
-    gpio_set(gpio_reset, 0);
+    backend->set_reset(backend, 0);
     usleep(20000);
-    gpio_set(gpio_reset, 1);
+    backend->set_reset(backend, 1);
     usleep(20000);
 
-    // Init SPI
-    if (spi_init(&lcd->spi, spi_dev,
-                 SPI_MODE_0,
-                 16000000,
-                 8) < 0) {
-        return -1;
-    }
+    // Defaults measured on a Pi Zero with spidev + libgpiod
+    lcd->cost.syscall_ns = 20000;
+    lcd->cost.dc_toggle_ns = 5000;
+
+    lcd->shadow = malloc(ST7735S_WIDTH * ST7735S_HEIGHT * sizeof(uint16_t));
+    lcd->shadow_valid = 0;
 
     // Run LCD init sequence
     run_init_sequence(lcd);
@@ -119,32 +142,76 @@ int st7735s_init(st7735s_t *lcd,
     return 0;
 }
 
+void st7735s_queue_cmd(st7735s_t *lcd, uint8_t cmd,
+                       const uint8_t *params, size_t n)
+{
+    queue_bytes(lcd, 0, &cmd, 1);
+    lcd->stats.commands++;
+    if (n > 0)
+        queue_bytes(lcd, 1, params, n);
+}
+
+void st7735s_queue_data(st7735s_t *lcd, const uint8_t *buf, size_t len)
+{
+    queue_segment(lcd, 1, buf, len);
+}
+
+void st7735s_flush(st7735s_t *lcd)
+{
+    st7735s_queue_t *q = &lcd->queue;
+    int i = 0;
+
+    while (i < q->count) {
+        // One ioctl for each run of segments sharing a DC level
+        int start = i;
+        while (i < q->count && q->dc[i] == q->dc[start])
+            i++;
+
+        set_dc(lcd, q->dc[start]);
+        lcd->backend->write(lcd->backend, &q->seg[start], i - start);
+
+        lcd->stats.messages++;
+        for (int k = start; k < i; k++)
+            lcd->stats.bytes += q->seg[k].len;
+    }
+
+    q->count = 0;
+    q->used = 0;
+}
+
+static void queue_addr_window(st7735s_t *lcd,
+                              uint8_t x0, uint8_t y0,
+                              uint8_t x1, uint8_t y1)
+{
+    uint8_t caset[4] = { 0, x0 + ST7735S_X_OFFSET, 0, x1 + ST7735S_X_OFFSET };
+    uint8_t raset[4] = { 0, y0 + ST7735S_Y_OFFSET, 0, y1 + ST7735S_Y_OFFSET };
+
+    st7735s_queue_cmd(lcd, 0x2A, caset, 4);    // CASET
+    st7735s_queue_cmd(lcd, 0x2B, raset, 4);    // RASET
+    st7735s_queue_cmd(lcd, 0x2C, NULL, 0);     // RAMWR
+
+    lcd->stats.windows++;
+}
+
 void st7735s_set_addr_window(st7735s_t *lcd,
                              uint8_t x0, uint8_t y0,
                              uint8_t x1, uint8_t y1)
 {
-    write_cmd(lcd, 0x2A); // CASET
-    write_data(lcd, 0);
-    write_data(lcd, x0 + ST7735S_X_OFFSET);
-    write_data(lcd, 0);
-    write_data(lcd, x1 + ST7735S_X_OFFSET);
-
-    write_cmd(lcd, 0x2B); // RASET
-    write_data(lcd, 0);
-    write_data(lcd, y0 + ST7735S_Y_OFFSET);
-    write_data(lcd, 0);
-    write_data(lcd, y1 + ST7735S_Y_OFFSET);
-
-    write_cmd(lcd, 0x2C); // RAMWR
+    queue_addr_window(lcd, x0, y0, x1, y1);
+    st7735s_flush(lcd);
 }
 
 void st7735s_draw_pixel(st7735s_t *lcd,
                         uint8_t x, uint8_t y,
                         uint16_t color)
 {
-    st7735s_set_addr_window(lcd, x, y, x, y);
+    lcd->shadow_valid = 0;
     uint8_t buf[2] = { color >> 8, color & 0xFF };
-    write_data_buf(lcd, buf, 2);
+
+    // Window and pixel in one flush
+    queue_addr_window(lcd, x, y, x, y);
+    st7735s_queue_data(lcd, buf, 2);
+    st7735s_flush(lcd);
 }
 
 void st7735s_fill_rect(st7735s_t *lcd,
@@ -152,6 +219,7 @@ void st7735s_fill_rect(st7735s_t *lcd,
                        uint8_t w, uint8_t h,
                        uint16_t color)
 {
+    lcd->shadow_valid = 0;
     st7735s_set_addr_window(lcd, x, y, x + w - 1, y + h - 1);
 
     size_t pixels = w * h;
@@ -185,6 +253,7 @@ void st7735s_draw_hline(st7735s_t *lcd,
         w = -w;
     }
 
+    lcd->shadow_valid = 0;
     st7735s_set_addr_window(lcd, x, y, x + w - 1, y);
     uint8_t buf[w * 2];
 
@@ -206,6 +275,7 @@ void st7735s_draw_vline(st7735s_t *lcd,
         h = -h;
     }
 
+    lcd->shadow_valid = 0;
     st7735s_set_addr_window(lcd, x, y, x, y + h - 1);
     uint8_t buf[h * 2];
 
@@ -221,16 +291,129 @@ void st7735s_push_framebuffer(st7735s_t *lcd,
                               uint16_t *fb,
                               int w, int h)
 {
-    // Set window to full screen
-    st7735s_set_addr_window(lcd, 0, 0, w - 1, h - 1);
+    // Full screen window and the framebuffer itself, no staging copy
+    queue_addr_window(lcd, 0, 0, w - 1, h - 1);
+    st7735s_queue_data(lcd, (const uint8_t*)fb, w * h * sizeof(uint16_t));
+    st7735s_flush(lcd);
+}
+
+void st7735s_push_rect(st7735s_t *lcd,
+                       const uint16_t *fb, int fb_w,
+                       int x0, int y0,
+                       int x1, int y1)
+{
+    int w = x1 - x0 + 1;
+    int h = y1 - y0 + 1;
+
+    if (w <= 0 || h <= 0)
+        return;
+
+    queue_addr_window(lcd, x0, y0, x1, y1);
+
+    if (w == fb_w) {
+        // Full width rows are contiguous in the framebuffer
+        st7735s_queue_data(lcd, (const uint8_t*)&fb[y0 * fb_w],
+                           w * h * sizeof(uint16_t));
+    } else {
+        // One transfer per row, straight out of the framebuffer
+        for (int y = y0; y <= y1; y++)
+            st7735s_queue_data(lcd, (const uint8_t*)&fb[y * fb_w + x0],
+                               w * sizeof(uint16_t));
+    }
+
+    st7735s_flush(lcd);
+}
+
+// Window overhead in wire bytes: five DC phases for CASET/RASET/RAMWR
+// plus the pixel data phase, each one ioctl and one DC set
+static uint32_t window_overhead_bytes(const st7735s_t *lcd)
+{
+    const uint32_t phases = 5 + 1;
+    uint64_t ns = (uint64_t)phases * (lcd->cost.syscall_ns + lcd->cost.dc_toggle_ns);
+    uint32_t hz = lcd->backend->speed_hz ? lcd->backend->speed_hz : 1;
+    uint64_t byte_ns = 8ULL * 1000000000ULL / hz;
+
+    return 11 + ns / (byte_ns ? byte_ns : 1);
+}
+
+static void flush_span_group(st7735s_t *lcd, const uint16_t *fb,
+                             int x0, int y0, int x1, int y1)
+{
+    st7735s_push_rect(lcd, fb, ST7735S_WIDTH, x0, y0, x1, y1);
+
+    for (int y = y0; y <= y1; y++)
+        memcpy(&lcd->shadow[y * ST7735S_WIDTH + x0],
+               &fb[y * ST7735S_WIDTH + x0],
+               (x1 - x0 + 1) * sizeof(uint16_t));
+}
+
+void st7735s_push_framebuffer_diff(st7735s_t *lcd,
+                                   const uint16_t *fb,
+                                   int y0, int y1)
+{
+    const int w = ST7735S_WIDTH;
+
+    // Panel content unknown, resend everything once
+    if (!lcd->shadow || !lcd->shadow_valid) {
+        st7735s_push_framebuffer(lcd, (uint16_t*)fb, w, ST7735S_HEIGHT);
+        if (lcd->shadow) {
+            memcpy(lcd->shadow, fb, w * ST7735S_HEIGHT * sizeof(uint16_t));
+            lcd->shadow_valid = 1;
+        }
+        return;
+    }
+
+    if (y0 < 0) y0 = 0;
+    if (y1 >= ST7735S_HEIGHT) y1 = ST7735S_HEIGHT - 1;
+
+    const uint32_t overhead = window_overhead_bytes(lcd);
+
+    // Current group of rows sharing one window, gx1 < gx0 when empty
+    int gx0 = w, gx1 = -1, gy0 = 0, gy1 = 0;
+
+    for (int y = y0; y <= y1; y++) {
+        const uint16_t *row = &fb[y * w];
+        const uint16_t *old = &lcd->shadow[y * w];
+
+        int a = 0, b = w - 1;
+        while (a < w && row[a] == old[a]) a++;
+        if (a == w)
+            continue;
+        while (row[b] == old[b]) b--;
+
+        if (gx1 < gx0) {
+            gx0 = a; gx1 = b; gy0 = gy1 = y;
+            continue;
+        }
 
-    // Data mode
-    gpio_set(lcd->pin_dc, 1);
+        // Merged window also resends any unchanged rows in between
+        int mx0 = a < gx0 ? a : gx0;
+        int mx1 = b > gx1 ? b : gx1;
+        uint32_t merged   = overhead + 2 * (mx1 - mx0 + 1) * (y - gy0 + 1);
+        uint32_t separate = overhead + 2 * (gx1 - gx0 + 1) * (gy1 - gy0 + 1) +
+                            overhead + 2 * (b - a + 1);
 
-    // Send entire framebuffer in one big SPI write
-    spi_write_chunked(&lcd->spi,
-                      (uint8_t*)fb,
-                      w * h * sizeof(uint16_t));
+        if (merged <= separate) {
+            gx0 = mx0; gx1 = mx1; gy1 = y;
+        } else {
+            flush_span_group(lcd, fb, gx0, gy0, gx1, gy1);
+            gx0 = a; gx1 = b; gy0 = gy1 = y;
+        }
+    }
+
+    if (gx1 >= gx0)
+        flush_span_group(lcd, fb, gx0, gy0, gx1, gy1);
+}
+
+void st7735s_close(st7735s_t *lcd)
+{
+    free(lcd->shadow);
+    lcd->shadow = NULL;
+
+    if (lcd->backend) {
+        lcd->backend->close(lcd->backend);
+        lcd->backend = NULL;
+    }
 }
 
 void st7735s_draw_line(st7735s_t *lcd,
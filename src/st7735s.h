@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "spi.h"
+#include "st7735s_backend.h"
 
 // Display resolution (common ST7735S)
 #define ST7735S_WIDTH   128
@@ -11,16 +12,79 @@
 #define ST7735S_X_OFFSET 2
 #define ST7735S_Y_OFFSET 1
 
+/**
+ * Transfer cost model used to decide how changed rows are grouped into
+ * address windows. A window costs one SPI ioctl and one DC GPIO set per
+ * DC phase (see st7735s_flush), pixel bytes cost wire time at the
+ * backend's speed_hz.
+ */
 typedef struct {
-    spi_device_t spi;
-    int pin_dc;
-    int pin_reset;
+    uint32_t syscall_ns;        // per spidev write()/ioctl
+    uint32_t dc_toggle_ns;      // per gpio_set() on the DC line
+} st7735s_cost_t;
+
+#define ST7735S_QUEUE_BYTES     64
+#define ST7735S_QUEUE_SEGMENTS  64
+
+/**
+ * Queued command/data segments, sent by st7735s_flush() with one
+ * SPI_IOC_MESSAGE per run of equal DC level
+ */
+typedef struct {
+    uint8_t bytes[ST7735S_QUEUE_BYTES];     // copies of queued command bytes
+    size_t used;
+    spi_segment_t seg[ST7735S_QUEUE_SEGMENTS];
+    uint8_t dc[ST7735S_QUEUE_SEGMENTS];
+    int count;
+} st7735s_queue_t;
+
+/**
+ * Traffic counters, cumulative since st7735s_init()
+ */
+typedef struct {
+    uint64_t bytes;             // bytes handed to the backend
+    uint64_t commands;          // command bytes queued
+    uint64_t messages;          // backend writes, one per DC run
+    uint64_t dc_toggles;
+    uint64_t windows;           // CASET/RASET/RAMWR sequences
+} st7735s_stats_t;
+
+typedef struct {
+    st7735s_backend_t *backend;
+    int dc_level;               // last level driven on DC, -1 unknown
+
+    st7735s_queue_t queue;
+
+    st7735s_cost_t cost;
+    st7735s_stats_t stats;
+
+    // Copy of what the panel shows, for st7735s_push_framebuffer_diff()
+    uint16_t *shadow;
+    int shadow_valid;
 } st7735s_t;
 
-int st7735s_init(st7735s_t *lcd,
-                 const char *spi_dev,
-                 int gpio_dc,
-                 int gpio_reset);
+/**
+ * Reset and initialize the panel behind backend. The driver takes
+ * ownership of the backend and closes it in st7735s_close().
+ */
+int st7735s_init(st7735s_t *lcd, st7735s_backend_t *backend);
+
+/**
+ * Queue a command byte followed by its parameters
+ */
+void st7735s_queue_cmd(st7735s_t *lcd, uint8_t cmd,
+                       const uint8_t *params, size_t n);
+
+/**
+ * Queue data bytes. buf is referenced, not copied, and must stay valid
+ * until st7735s_flush().
+ */
+void st7735s_queue_data(st7735s_t *lcd, const uint8_t *buf, size_t len);
+
+/**
+ * Send everything queued, toggling DC only when the phase changes
+ */
+void st7735s_flush(st7735s_t *lcd);
 
 void st7735s_set_addr_window(st7735s_t *lcd,
                              uint8_t x0, uint8_t y0,
@@ -37,6 +101,27 @@ void st7735s_push_framebuffer(st7735s_t *lcd,
                               uint16_t *fb,
                               int w, int h);
 
+/**
+ * Send only the window x0..x1, y0..y1 (inclusive) of a framebuffer
+ * with fb_w pixels per row
+ */
+void st7735s_push_rect(st7735s_t *lcd,
+                       const uint16_t *fb, int fb_w,
+                       int x0, int y0,
+                       int x1, int y1);
+
+/**
+ * Diff rows y0..y1 of a full-screen framebuffer against the previously
+ * pushed frame and send only the changed row spans. Spans of adjacent
+ * rows share one address window when that is cheaper than paying for
+ * another window (see st7735s_cost_t).
+ */
+void st7735s_push_framebuffer_diff(st7735s_t *lcd,
+                                   const uint16_t *fb,
+                                   int y0, int y1);
+
+void st7735s_close(st7735s_t *lcd);
+
 void st7735s_draw_pixel(st7735s_t *lcd,
                         uint8_t x, uint8_t y,
                         uint16_t color);
@@ -0,0 +1,55 @@
+#include "st7735s_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Null sink
+
+static void null_set_line(st7735s_backend_t *be, int level)
+{
+}
+
+static int null_write(st7735s_backend_t *be,
+                      const spi_segment_t *seg, size_t n)
+{
+    return 0;
+}
+
+static void null_close(st7735s_backend_t *be)
+{
+    free(be);
+}
+
+st7735s_backend_t *st7735s_null_open(void)
+{
+    st7735s_backend_t *be = calloc(1, sizeof(*be));
+    if (!be)
+        return NULL;
+
+    be->name = "null";
+    be->speed_hz = 16000000;
+    be->set_dc = null_set_line;
+    be->set_reset = null_set_line;
+    be->write = null_write;
+    be->close = null_close;
+
+    return be;
+}
+
+st7735s_backend_t *st7735s_backend_open(const char *name,
+                                        const char *spi_dev,
+                                        int gpio_dc,
+                                        int gpio_reset)
+{
+    if (!name || !strcmp(name, "spidev"))
+        return st7735s_spidev_open(spi_dev, gpio_dc, gpio_reset);
+    if (!strcmp(name, "virtual"))
+        return st7735s_virtual_open();
+    if (!strcmp(name, "sim"))
+        return st7735s_sim_open(NULL);
+    if (!strcmp(name, "null"))
+        return st7735s_null_open();
+
+    printf("Unknown display backend: %s\n", name);
+    return NULL;
+}
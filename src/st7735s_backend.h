@@ -0,0 +1,99 @@
+#ifndef __ST7735S_BACKEND_H
+#define __ST7735S_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "spi.h"
+
+/**
+ * Transport under the ST7735S driver: drives the DC and RESET lines and
+ * writes byte segments. Implementations embed this struct as their first
+ * member.
+ */
+typedef struct st7735s_backend {
+    const char *name;
+    uint32_t speed_hz;      // bus clock, for the transfer cost model
+
+    void (*set_dc)(struct st7735s_backend *be, int level);
+    void (*set_reset)(struct st7735s_backend *be, int level);
+    int  (*write)(struct st7735s_backend *be,
+                  const spi_segment_t *seg, size_t n);
+    void (*close)(struct st7735s_backend *be);
+} st7735s_backend_t;
+
+// Controller GRAM, the 128x160 panel sits at ST7735S_X/Y_OFFSET inside it
+#define ST7735S_RAM_WIDTH   132
+#define ST7735S_RAM_HEIGHT  162
+
+/**
+ * Real panel: spidev for data, libgpiod for DC/RESET
+ */
+st7735s_backend_t *st7735s_spidev_open(const char *spi_dev,
+                                       int gpio_dc,
+                                       int gpio_reset);
+
+/**
+ * In-memory ST7735S: decodes CASET/RASET/RAMWR/MADCTL and keeps the
+ * controller RAM, for running the full pipeline without hardware
+ */
+st7735s_backend_t *st7735s_virtual_open(void);
+
+/**
+ * RGB565 value (as sent on the wire) at column/row x, y of the virtual
+ * panel's RAM. These are GRAM addresses after MADCTL: with the MX|MY
+ * of the init sequence, the pixel written at CASET/RASET x, y reads
+ * back at ST7735S_RAM_WIDTH - 1 - x, ST7735S_RAM_HEIGHT - 1 - y.
+ */
+uint16_t st7735s_virtual_read(st7735s_backend_t *be, int x, int y);
+
+uint8_t st7735s_virtual_madctl(st7735s_backend_t *be);
+
+/**
+ * Discards everything, measures pure pipeline throughput
+ */
+st7735s_backend_t *st7735s_null_open(void);
+
+/**
+ * Bus model for the sim backend
+ */
+typedef struct {
+    uint32_t speed_hz;      // SPI clock
+    uint32_t bufsiz;        // spidev bytes per SPI_IOC_MESSAGE
+    uint32_t syscall_ns;    // per ioctl
+    uint32_t dc_toggle_ns;  // per DC GPIO set
+    int pixel_bits;         // wire bits per pixel: 12, 16 or 24 (RGB666)
+} st7735s_sim_config_t;
+
+/**
+ * Modeled traffic, cumulative since st7735s_sim_open()
+ */
+typedef struct {
+    uint64_t ioctls;
+    uint64_t transfers;     // spi_ioc_transfer entries
+    uint64_t dc_toggles;
+    uint64_t bytes;         // wire bytes, pixel data scaled to pixel_bits
+    uint64_t pixel_bytes;   // of which RAMWR data
+    uint64_t wire_ns;       // modeled bus time including overheads
+} st7735s_sim_counters_t;
+
+void st7735s_sim_default_config(st7735s_sim_config_t *cfg);
+
+/**
+ * Discards the data but models what it would cost on a real spidev bus:
+ * messages are split like spi_write_segments() does, each costs
+ * syscall_ns plus wire time, each DC change dc_toggle_ns.
+ * cfg NULL: st7735s_sim_default_config().
+ */
+st7735s_backend_t *st7735s_sim_open(const st7735s_sim_config_t *cfg);
+
+const st7735s_sim_counters_t *st7735s_sim_counters(st7735s_backend_t *be);
+
+/**
+ * Open a backend by name: "spidev", "virtual", "sim" or "null"
+ */
+st7735s_backend_t *st7735s_backend_open(const char *name,
+                                        const char *spi_dev,
+                                        int gpio_dc,
+                                        int gpio_reset);
+
+#endif
@@ -0,0 +1,128 @@
+#include "st7735s_backend.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CMD_RAMWR       0x2C
+
+typedef struct {
+    st7735s_backend_t base;
+    st7735s_sim_config_t cfg;
+    st7735s_sim_counters_t counters;
+
+    int dc;
+    uint8_t cmd;            // last command byte, data after RAMWR is pixels
+} sim_backend_t;
+
+void st7735s_sim_default_config(st7735s_sim_config_t *cfg)
+{
+    // Same figures as the driver's transfer cost defaults
+    cfg->speed_hz = 16000000;
+    cfg->bufsiz = SPI_DEFAULT_BUFSIZ;
+    cfg->syscall_ns = 20000;
+    cfg->dc_toggle_ns = 5000;
+    cfg->pixel_bits = 16;
+}
+
+static void sim_set_dc(st7735s_backend_t *be, int level)
+{
+    sim_backend_t *sb = (sim_backend_t*)be;
+
+    // The driver only calls this when the level actually changes
+    sb->dc = level;
+    sb->counters.dc_toggles++;
+    sb->counters.wire_ns += sb->cfg.dc_toggle_ns;
+}
+
+static void sim_set_reset(st7735s_backend_t *be, int level)
+{
+}
+
+static void sim_submit(sim_backend_t *sb, uint64_t bytes)
+{
+    sb->counters.ioctls++;
+    sb->counters.wire_ns += sb->cfg.syscall_ns +
+                            bytes * 8ULL * 1000000000ULL / sb->cfg.speed_hz;
+}
+
+// Splits the segments into messages the same way spi_write_segments does
+static int sim_write(st7735s_backend_t *be,
+                     const spi_segment_t *seg, size_t n)
+{
+    sim_backend_t *sb = (sim_backend_t*)be;
+    const uint64_t bufsiz = sb->cfg.bufsiz;
+    size_t count = 0;
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t len = seg[i].len;
+
+        if (!sb->dc && len > 0) {
+            sb->cmd = seg[i].buf[len - 1];
+        } else if (sb->cmd == CMD_RAMWR) {
+            // What-if pixel format: the driver always emits RGB565
+            len = len * sb->cfg.pixel_bits / 16;
+            sb->counters.pixel_bytes += len;
+        }
+
+        sb->counters.bytes += len;
+
+        while (len > 0) {
+            if (count == SPI_MAX_SEGMENTS || total == bufsiz) {
+                sim_submit(sb, total);
+                count = 0;
+                total = 0;
+            }
+
+            uint64_t piece = bufsiz - total;
+            if (piece > len) piece = len;
+
+            sb->counters.transfers++;
+            count++;
+            len -= piece;
+            total += piece;
+        }
+    }
+
+    if (count > 0)
+        sim_submit(sb, total);
+
+    return 0;
+}
+
+static void sim_close(st7735s_backend_t *be)
+{
+    free(be);
+}
+
+st7735s_backend_t *st7735s_sim_open(const st7735s_sim_config_t *cfg)
+{
+    sim_backend_t *sb = calloc(1, sizeof(*sb));
+    if (!sb)
+        return NULL;
+
+    if (cfg)
+        sb->cfg = *cfg;
+    else
+        st7735s_sim_default_config(&sb->cfg);
+
+    if (!sb->cfg.speed_hz)
+        sb->cfg.speed_hz = 1;
+    if (!sb->cfg.bufsiz)
+        sb->cfg.bufsiz = SPI_DEFAULT_BUFSIZ;
+    if (!sb->cfg.pixel_bits)
+        sb->cfg.pixel_bits = 16;
+
+    sb->base.name = "sim";
+    sb->base.speed_hz = sb->cfg.speed_hz;
+    sb->base.set_dc = sim_set_dc;
+    sb->base.set_reset = sim_set_reset;
+    sb->base.write = sim_write;
+    sb->base.close = sim_close;
+
+    return &sb->base;
+}
+
+const st7735s_sim_counters_t *st7735s_sim_counters(st7735s_backend_t *be)
+{
+    return &((sim_backend_t*)be)->counters;
+}
@@ -0,0 +1,68 @@
+#include "st7735s_backend.h"
+#include "gpio.h"
+#include "spi.h"
+#include <linux/spi/spidev.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    st7735s_backend_t base;
+    spi_device_t spi;
+    int pin_dc;
+    int pin_reset;
+} spidev_backend_t;
+
+static void spidev_set_dc(st7735s_backend_t *be, int level)
+{
+    gpio_set(((spidev_backend_t*)be)->pin_dc, level);
+}
+
+static void spidev_set_reset(st7735s_backend_t *be, int level)
+{
+    gpio_set(((spidev_backend_t*)be)->pin_reset, level);
+}
+
+static int spidev_write(st7735s_backend_t *be,
+                        const spi_segment_t *seg, size_t n)
+{
+    return spi_write_segments(&((spidev_backend_t*)be)->spi, seg, n);
+}
+
+static void spidev_close(st7735s_backend_t *be)
+{
+    spi_close(&((spidev_backend_t*)be)->spi);
+    free(be);
+}
+
+st7735s_backend_t *st7735s_spidev_open(const char *spi_dev,
+                                       int gpio_dc,
+                                       int gpio_reset)
+{
+    spidev_backend_t *sb = calloc(1, sizeof(*sb));
+    if (!sb)
+        return NULL;
+
+    sb->pin_dc = gpio_dc;
+    sb->pin_reset = gpio_reset;
+
+    gpio_request_output(gpio_dc);
+    gpio_request_output(gpio_reset);
+
+    // Init SPI
+    if (spi_init(&sb->spi, spi_dev,
+                 SPI_MODE_0,
+                 16000000,
+                 8) < 0) {
+        free(sb);
+        return NULL;
+    }
+
+    sb->base.name = "spidev";
+    sb->base.speed_hz = sb->spi.speed_hz;
+    sb->base.set_dc = spidev_set_dc;
+    sb->base.set_reset = spidev_set_reset;
+    sb->base.write = spidev_write;
+    sb->base.close = spidev_close;
+
+    return &sb->base;
+}
@@ -0,0 +1,208 @@
+#include "st7735s_backend.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CMD_SWRESET     0x01
+#define CMD_SLPOUT      0x11
+#define CMD_DISPON      0x29
+#define CMD_CASET       0x2A
+#define CMD_RASET       0x2B
+#define CMD_RAMWR       0x2C
+#define CMD_MADCTL      0x36
+#define CMD_COLMOD      0x3A
+
+#define MADCTL_MY       0x80    // row address order
+#define MADCTL_MX       0x40    // column address order
+#define MADCTL_MV       0x20    // row/column exchange
+
+typedef struct {
+    st7735s_backend_t base;
+
+    int dc;
+    uint8_t cmd;
+    int nparam;
+    uint8_t param[4];
+
+    // Address window and write pointer, in CASET/RASET coordinates
+    uint16_t xs, xe, ys, ye;
+    uint16_t x, y;
+    int have_hi;
+    uint8_t hi;
+
+    uint8_t madctl;
+    uint8_t colmod;
+    int sleeping;
+    int display_on;
+
+    uint16_t ram[ST7735S_RAM_HEIGHT][ST7735S_RAM_WIDTH];
+} virtual_backend_t;
+
+static void virtual_reset_state(virtual_backend_t *vb)
+{
+    vb->cmd = 0;
+    vb->nparam = 0;
+    vb->have_hi = 0;
+    vb->xs = 0;
+    vb->xe = ST7735S_RAM_WIDTH - 1;
+    vb->ys = 0;
+    vb->ye = ST7735S_RAM_HEIGHT - 1;
+    vb->x = vb->y = 0;
+    vb->madctl = 0;
+    vb->colmod = 0x06;
+    vb->sleeping = 1;
+    vb->display_on = 0;
+}
+
+static void virtual_store_pixel(virtual_backend_t *vb, uint16_t color)
+{
+    // MV: the window addresses are exchanged on their way to GRAM
+    int col = vb->madctl & MADCTL_MV ? vb->y : vb->x;
+    int row = vb->madctl & MADCTL_MV ? vb->x : vb->y;
+
+    if (col < ST7735S_RAM_WIDTH && row < ST7735S_RAM_HEIGHT) {
+        // MX/MY: then mirrored across the whole GRAM, not just the panel
+        if (vb->madctl & MADCTL_MX)
+            col = ST7735S_RAM_WIDTH - 1 - col;
+        if (vb->madctl & MADCTL_MY)
+            row = ST7735S_RAM_HEIGHT - 1 - row;
+
+        vb->ram[row][col] = color;
+    }
+
+    // Column first, then row, wrapping inside the window
+    if (++vb->x > vb->xe) {
+        vb->x = vb->xs;
+        if (++vb->y > vb->ye)
+            vb->y = vb->ys;
+    }
+}
+
+static void virtual_command(virtual_backend_t *vb, uint8_t cmd)
+{
+    vb->cmd = cmd;
+    vb->nparam = 0;
+    vb->have_hi = 0;
+
+    switch (cmd) {
+    case CMD_SWRESET:
+        virtual_reset_state(vb);
+        break;
+    case CMD_SLPOUT:
+        vb->sleeping = 0;
+        break;
+    case CMD_DISPON:
+        vb->display_on = 1;
+        break;
+    case CMD_RAMWR:
+        vb->x = vb->xs;
+        vb->y = vb->ys;
+        break;
+    }
+}
+
+static void virtual_data(virtual_backend_t *vb, uint8_t byte)
+{
+    switch (vb->cmd) {
+    case CMD_CASET:
+    case CMD_RASET:
+        if (vb->nparam < 4)
+            vb->param[vb->nparam++] = byte;
+        if (vb->nparam == 4) {
+            uint16_t s = vb->param[0] << 8 | vb->param[1];
+            uint16_t e = vb->param[2] << 8 | vb->param[3];
+            if (vb->cmd == CMD_CASET) {
+                vb->xs = s;
+                vb->xe = e;
+            } else {
+                vb->ys = s;
+                vb->ye = e;
+            }
+        }
+        break;
+
+    case CMD_RAMWR:
+        // 16-bit RGB565, high byte first
+        if (!vb->have_hi) {
+            vb->hi = byte;
+            vb->have_hi = 1;
+        } else {
+            virtual_store_pixel(vb, vb->hi << 8 | byte);
+            vb->have_hi = 0;
+        }
+        break;
+
+    case CMD_MADCTL:
+        vb->madctl = byte;
+        break;
+
+    case CMD_COLMOD:
+        vb->colmod = byte;
+        break;
+    }
+}
+
+static void virtual_set_dc(st7735s_backend_t *be, int level)
+{
+    ((virtual_backend_t*)be)->dc = level;
+}
+
+static void virtual_set_reset(st7735s_backend_t *be, int level)
+{
+    if (!level)
+        virtual_reset_state((virtual_backend_t*)be);
+}
+
+static int virtual_write(st7735s_backend_t *be,
+                         const spi_segment_t *seg, size_t n)
+{
+    virtual_backend_t *vb = (virtual_backend_t*)be;
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = 0; k < seg[i].len; k++) {
+            if (vb->dc)
+                virtual_data(vb, seg[i].buf[k]);
+            else
+                virtual_command(vb, seg[i].buf[k]);
+        }
+    }
+
+    return 0;
+}
+
+static void virtual_close(st7735s_backend_t *be)
+{
+    free(be);
+}
+
+st7735s_backend_t *st7735s_virtual_open(void)
+{
+    virtual_backend_t *vb = calloc(1, sizeof(*vb));
+    if (!vb)
+        return NULL;
+
+    virtual_reset_state(vb);
+
+    vb->base.name = "virtual";
+    vb->base.speed_hz = 16000000;
+    vb->base.set_dc = virtual_set_dc;
+    vb->base.set_reset = virtual_set_reset;
+    vb->base.write = virtual_write;
+    vb->base.close = virtual_close;
+
+    return &vb->base;
+}
+
+uint16_t st7735s_virtual_read(st7735s_backend_t *be, int x, int y)
+{
+    virtual_backend_t *vb = (virtual_backend_t*)be;
+
+    if (x < 0 || x >= ST7735S_RAM_WIDTH || y < 0 || y >= ST7735S_RAM_HEIGHT)
+        return 0;
+
+    return vb->ram[y][x];
+}
+
+uint8_t st7735s_virtual_madctl(st7735s_backend_t *be)
+{
+    return ((virtual_backend_t*)be)->madctl;
+}
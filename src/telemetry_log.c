@@ -0,0 +1,98 @@
+#include "telemetry_log.h"
+#include <string.h>
+
+int telemetry_log_create(telemetry_log_t *log, const char *path,
+                         uint64_t start_us)
+{
+    log->f = fopen(path, "wb");
+    log->last_us = start_us;
+
+    if (!log->f)
+        return -1;
+
+    if (fwrite(TELEMETRY_LOG_MAGIC, 8, 1, log->f) != 1) {
+        fclose(log->f);
+        log->f = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+int telemetry_log_write(telemetry_log_t *log, uint64_t t_us,
+                        const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t n = len > TELEMETRY_LOG_MAX_CHUNK ? TELEMETRY_LOG_MAX_CHUNK : len;
+        uint64_t delta = t_us - log->last_us;
+        if (delta > UINT32_MAX)
+            delta = UINT32_MAX;
+
+        uint8_t hdr[6] = {
+            delta, delta >> 8, delta >> 16, delta >> 24,
+            n, n >> 8,
+        };
+
+        if (fwrite(hdr, sizeof(hdr), 1, log->f) != 1 ||
+            fwrite(data, n, 1, log->f) != 1)
+            return -1;
+
+        log->last_us = t_us;
+        data += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+int telemetry_log_flush(telemetry_log_t *log)
+{
+    return fflush(log->f);
+}
+
+int telemetry_log_open(telemetry_log_t *log, const char *path)
+{
+    char magic[8];
+
+    log->f = fopen(path, "rb");
+    log->last_us = 0;
+
+    if (!log->f)
+        return -1;
+
+    if (fread(magic, 8, 1, log->f) != 1 ||
+        memcmp(magic, TELEMETRY_LOG_MAGIC, 8)) {
+        fclose(log->f);
+        log->f = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+int telemetry_log_read(telemetry_log_t *log, uint64_t *t_us,
+                       uint8_t *data, size_t max)
+{
+    uint8_t hdr[6];
+
+    if (fread(hdr, sizeof(hdr), 1, log->f) != 1)
+        return feof(log->f) ? 0 : -1;
+
+    uint32_t delta = hdr[0] | hdr[1] << 8 | hdr[2] << 16 | (uint32_t)hdr[3] << 24;
+    size_t len = hdr[4] | hdr[5] << 8;
+
+    if (len > max || fread(data, len, 1, log->f) != 1)
+        return -1;
+
+    log->last_us += delta;
+    *t_us = log->last_us;
+
+    return len;
+}
+
+void telemetry_log_close(telemetry_log_t *log)
+{
+    if (log->f)
+        fclose(log->f);
+    log->f = NULL;
+}
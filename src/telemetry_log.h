@@ -0,0 +1,45 @@
+#ifndef __TELEMETRY_LOG_H_
+#define __TELEMETRY_LOG_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Raw UART capture: the bytes of every read() with their arrival time,
+ * so a replay goes through the same parser as the live link.
+ *
+ *   "KSPTLM1\n"
+ *   records: delta_us:u32 len:u16 bytes[len]      (little endian)
+ *
+ * delta_us is relative to the previous record (the first record: to
+ * the start of the capture).
+ */
+#define TELEMETRY_LOG_MAGIC     "KSPTLM1\n"
+#define TELEMETRY_LOG_MAX_CHUNK 65535
+
+typedef struct {
+    FILE *f;
+    uint64_t last_us;
+} telemetry_log_t;
+
+int telemetry_log_create(telemetry_log_t *log, const char *path,
+                         uint64_t start_us);
+
+int telemetry_log_write(telemetry_log_t *log, uint64_t t_us,
+                        const uint8_t *data, size_t len);
+
+int telemetry_log_flush(telemetry_log_t *log);
+
+int telemetry_log_open(telemetry_log_t *log, const char *path);
+
+/**
+ * Next record, returns its length (0 at end of log, -1 on a damaged
+ * log). *t_us is the time since the start of the capture.
+ */
+int telemetry_log_read(telemetry_log_t *log, uint64_t *t_us,
+                       uint8_t *data, size_t max);
+
+void telemetry_log_close(telemetry_log_t *log);
+
+#endif
@@ -0,0 +1,97 @@
+#include "texture.h"
+#include "texture_layout.h"
+#include "navball_texture.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+void texture_builtin(texture_t *tex)
+{
+    tex->width = NAVBALL_TEXTURE_WIDTH;
+    tex->height = NAVBALL_TEXTURE_HEIGHT;
+    tex->palette = navball_palette;
+    tex->texels = navball_texture;
+    tex->map = NULL;
+    tex->map_size = 0;
+}
+
+static int texture_header_valid(const texture_file_header_t *h, size_t size)
+{
+    if (memcmp(h->magic, TEXTURE_MAGIC, 8))
+        return 0;
+
+    if (h->format != TEXTURE_FORMAT_I8 || h->layout != TEXTURE_LAYOUT_NATIVE)
+        return 0;
+
+    if (!h->width || h->width > TEXTURE_MAX_WIDTH ||
+        !h->height || h->height > TEXTURE_MAX_HEIGHT)
+        return 0;
+
+    if (h->layout == TEXTURE_LAYOUT_TILED &&
+        ((h->width | h->height) & TEXTURE_TILE_MASK))
+        return 0;
+
+    // Every u8 index must land inside the palette
+    if (h->palette_size != 256)
+        return 0;
+
+    if (h->palette_offset % TEXTURE_DATA_ALIGN || h->texel_offset % TEXTURE_DATA_ALIGN)
+        return 0;
+
+    if (h->palette_offset < sizeof(*h) ||
+        (uint64_t)h->palette_offset + h->palette_size * 2 > size ||
+        h->texel_offset < sizeof(*h) ||
+        (uint64_t)h->texel_offset + (uint64_t)h->width * h->height > size)
+        return 0;
+
+    return 1;
+}
+
+int texture_open(texture_t *tex, const char *path)
+{
+    struct stat st;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(texture_file_header_t)) {
+        close(fd);
+        return -1;
+    }
+
+    // Shared and populated up front: no page faults in the first frames
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+        return -1;
+
+    const texture_file_header_t *h = map;
+
+    if (!texture_header_valid(h, st.st_size)) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    tex->width = h->width;
+    tex->height = h->height;
+    tex->palette = (const uint16_t*)((const uint8_t*)map + h->palette_offset);
+    tex->texels = (const uint8_t*)map + h->texel_offset;
+    tex->map = map;
+    tex->map_size = st.st_size;
+
+    return 0;
+}
+
+void texture_close(texture_t *tex)
+{
+    if (tex->map)
+        munmap(tex->map, tex->map_size);
+
+    tex->map = NULL;
+    tex->texels = NULL;
+    tex->palette = NULL;
+}
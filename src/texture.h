@@ -0,0 +1,66 @@
+#ifndef __TEXTURE_H_
+#define __TEXTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Navball texture asset, mmap'd read-only so every lcd_app instance
+ * shares the page cache copy and loading costs no copy.
+ *
+ *   header (texture_file_header_t, padded to TEXTURE_DATA_ALIGN)
+ *   palette: u16 RGB565 x palette_size        at palette_offset
+ *   texels:  u8 palette index x width*height  at texel_offset
+ *
+ * Header fields are little endian. Palette entries are big endian, the
+ * panel's byte order, so they go into the framebuffer as mapped.
+ * Offsets are from the start of the file and aligned to
+ * TEXTURE_DATA_ALIGN (a cache line). Written by tools/texture_convert.
+ */
+#define TEXTURE_MAGIC           "KSPTEX2\n"
+#define TEXTURE_DATA_ALIGN      64
+
+#define TEXTURE_FORMAT_I8       1   // 8 bit palette indices
+
+#define TEXTURE_LAYOUT_LINEAR   0
+#define TEXTURE_LAYOUT_TILED    1   // see texture_layout.h
+
+// Rows of the fixed-point row lookup are 8 bit
+#define TEXTURE_MAX_WIDTH       4096
+#define TEXTURE_MAX_HEIGHT      256
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint16_t width;
+    uint16_t height;
+    uint8_t format;
+    uint8_t layout;
+    uint16_t palette_size;
+    uint32_t palette_offset;
+    uint32_t texel_offset;
+} texture_file_header_t;
+
+typedef struct {
+    int width;
+    int height;
+    const uint16_t *palette;
+    const uint8_t *texels;
+
+    void *map;          // NULL for the built-in texture
+    size_t map_size;
+} texture_t;
+
+/**
+ * The texture compiled into the binary (navball_texture.h)
+ */
+void texture_builtin(texture_t *tex);
+
+/**
+ * Map a texture file. Fails (-1) on I/O errors, malformed files and
+ * files in a layout other than the one this build samples.
+ */
+int texture_open(texture_t *tex, const char *path);
+
+void texture_close(texture_t *tex);
+
+#endif
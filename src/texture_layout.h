@@ -0,0 +1,43 @@
+#ifndef __TEXTURE_LAYOUT_H_
+#define __TEXTURE_LAYOUT_H_
+
+/**
+ * Texel addressing of the navball texture.
+ *
+ * Default layout is 8x8 tiles (64 bytes of 8-bit palette indices, one
+ * cache line on a Cortex-A7) stored row by row, texels inside a tile
+ * row-major. Screen rows map to diagonal or curved texel walks once the
+ * ball rolls on screen. With tiles, vertically neighbouring texels sit
+ * 8 bytes apart, in the same line, instead of a texture row (256 bytes
+ * for the 256 wide texture).
+ *
+ * HORIZON_TEXTURE_LINEAR keeps the plain row-major array, for
+ * comparison. Texture width and height must be multiples of the tile.
+ */
+
+#define TEXTURE_TILE_SHIFT  3
+#define TEXTURE_TILE        (1 << TEXTURE_TILE_SHIFT)
+#define TEXTURE_TILE_MASK   (TEXTURE_TILE - 1)
+
+// Layout texture_index() addresses, texture files must match it
+#if defined(HORIZON_TEXTURE_LINEAR)
+#define TEXTURE_LAYOUT_NATIVE   TEXTURE_LAYOUT_LINEAR
+#else
+#define TEXTURE_LAYOUT_NATIVE   TEXTURE_LAYOUT_TILED
+#endif
+
+static inline int texture_index(int tx, int ty, int tex_w)
+{
+#if defined(HORIZON_TEXTURE_LINEAR)
+    return ty * tex_w + tx;
+#else
+    int tile = (ty >> TEXTURE_TILE_SHIFT) * (tex_w >> TEXTURE_TILE_SHIFT) +
+               (tx >> TEXTURE_TILE_SHIFT);
+
+    return (tile << (2 * TEXTURE_TILE_SHIFT)) +
+           ((ty & TEXTURE_TILE_MASK) << TEXTURE_TILE_SHIFT) +
+           (tx & TEXTURE_TILE_MASK);
+#endif
+}
+
+#endif
@@ -0,0 +1,236 @@
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+typedef struct __attribute__((packed)){
+    uint8_t start_byte;
+    int16_t pitch;
+    int16_t roll;
+    int16_t yaw;
+}uart_packet;
+
+int uart_open(const char *path)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+        return -1;
+
+    struct termios tty;
+    tcgetattr(fd, &tty);
+    cfsetospeed(&tty, B115200);
+    cfsetispeed(&tty, B115200);
+    tty.c_cflag = CS8 | CREAD | CLOCAL;
+    tty.c_lflag = 0;
+    tty.c_iflag = 0;
+    tty.c_oflag = 0;
+
+    // Wake up per packet, not per byte
+    tty.c_cc[VMIN] = UART_PACKET_SIZE;
+    tty.c_cc[VTIME] = 1;
+    tcsetattr(fd, TCSANOW, &tty);
+
+    return fd;
+}
+
+void uart_parser_init(uart_parser_t *p, uart_protocol_t protocol)
+{
+    memset(p, 0, sizeof(*p));
+    p->protocol = protocol;
+}
+
+static int parse_legacy(uart_parser_t *p, uint8_t byte, attitude_t *latest)
+{
+    switch (p->state) {
+    case 0:
+        /**
+         * Check if the first received byte is the starting byte (0xAA)
+         * If it is, switch state to 1 so that every following byte
+         * goes into the packet. Once idx == UART_PACKET_SIZE (7 bytes)
+         * the packet is complete.
+         */
+        if (byte == UART_START_BYTE) {
+            p->buf[0] = byte;
+            p->idx = 1;
+            p->state = 1;
+        }
+        break;
+
+    case 1:
+        p->buf[p->idx++] = byte;
+
+        if (p->idx == UART_PACKET_SIZE) {
+            uart_packet pkt;
+            memcpy(&pkt, p->buf, UART_PACKET_SIZE);
+
+            latest->pitch = pkt.pitch;
+            latest->roll = pkt.roll;
+            latest->yaw = pkt.yaw;
+            latest->seq = 0;
+            latest->sender_us = 0;
+            latest->flags = 0;
+
+            p->counters.frames++;
+            p->state = 0;
+            return 1;
+        }
+        break;
+    }
+
+    return 0;
+}
+
+uint16_t uart_crc16(const uint8_t *data, size_t n)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < n; i++) {
+        crc ^= data[i] << 8;
+        for (int k = 0; k < 8; k++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+static uint16_t get_u16(const uint8_t *b)
+{
+    return b[0] | b[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *b)
+{
+    return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static void put_u16(uint8_t *b, uint16_t v)
+{
+    b[0] = v;
+    b[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *b, uint32_t v)
+{
+    put_u16(b, v);
+    put_u16(b + 2, v >> 16);
+}
+
+size_t uart_frame_encode(uint8_t out[UART_FRAME_SIZE], const attitude_t *a)
+{
+    out[0] = UART_SYNC0;
+    out[1] = UART_SYNC1;
+    out[2] = UART_FRAME_VERSION;
+    out[3] = UART_FRAME_PAYLOAD;
+
+    uint8_t *pl = &out[UART_FRAME_HEADER];
+    put_u16(pl + 0, a->seq);
+    put_u32(pl + 2, a->sender_us);
+    put_u16(pl + 6, a->pitch);
+    put_u16(pl + 8, a->roll);
+    put_u16(pl + 10, a->yaw);
+
+    put_u16(&out[UART_FRAME_SIZE - 2],
+            uart_crc16(&out[2], UART_FRAME_SIZE - 4));
+
+    return UART_FRAME_SIZE;
+}
+
+// Drop the first byte of the candidate frame and look for sync again
+// in what follows it
+static void resync(uart_parser_t *p)
+{
+    memmove(p->buf, p->buf + 1, --p->idx);
+    p->counters.skipped++;
+}
+
+// Sequence bookkeeping, 0 if the frame repeats the previous one
+static int accept_seq(uart_parser_t *p, uint16_t seq)
+{
+    if (p->have_seq) {
+        uint16_t delta = seq - p->last_seq;
+
+        if (delta == 0) {
+            p->counters.duplicated++;
+            return 0;
+        }
+
+        // Backwards jumps are a restarted sender, not losses
+        if (delta < 0x8000)
+            p->counters.dropped += delta - 1;
+    }
+
+    p->have_seq = 1;
+    p->last_seq = seq;
+    return 1;
+}
+
+// Try to complete a frame from buf, 1 when latest was filled in
+static int scan_framed(uart_parser_t *p, attitude_t *latest)
+{
+    while (p->idx > 0) {
+        const uint8_t *b = p->buf;
+
+        if (b[0] != UART_SYNC0 || (p->idx > 1 && b[1] != UART_SYNC1)) {
+            resync(p);
+            continue;
+        }
+
+        if (p->idx < UART_FRAME_HEADER)
+            return 0;
+
+        if (b[2] != UART_FRAME_VERSION || b[3] != UART_FRAME_PAYLOAD) {
+            p->counters.corrupt++;
+            resync(p);
+            continue;
+        }
+
+        if (p->idx < UART_FRAME_SIZE)
+            return 0;
+
+        if (uart_crc16(&b[2], UART_FRAME_SIZE - 4) !=
+            get_u16(&b[UART_FRAME_SIZE - 2])) {
+            p->counters.corrupt++;
+            resync(p);
+            continue;
+        }
+
+        p->idx = 0;
+
+        const uint8_t *pl = &b[UART_FRAME_HEADER];
+        uint16_t seq = get_u16(pl);
+        if (!accept_seq(p, seq))
+            return 0;
+
+        latest->seq = seq;
+        latest->sender_us = get_u32(pl + 2);
+        latest->pitch = (int16_t)get_u16(pl + 6);
+        latest->roll = (int16_t)get_u16(pl + 8);
+        latest->yaw = (int16_t)get_u16(pl + 10);
+        latest->flags = ATTITUDE_SENDER_TIME;
+
+        p->counters.frames++;
+        return 1;
+    }
+
+    return 0;
+}
+
+int uart_parse(uart_parser_t *p, const uint8_t *data, size_t n,
+               attitude_t *latest)
+{
+    int packets = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (p->protocol == UART_PROTOCOL_LEGACY) {
+            packets += parse_legacy(p, data[i], latest);
+            continue;
+        }
+
+        p->buf[p->idx++] = data[i];
+        packets += scan_framed(p, latest);
+    }
+
+    return packets;
+}
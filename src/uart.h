@@ -0,0 +1,84 @@
+#ifndef __UART_H_
+#define __UART_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "attitude.h"
+
+// Legacy packet: 0xAA followed by pitch, roll, yaw as int16
+#define UART_PACKET_SIZE    7
+#define UART_START_BYTE     0xAA
+
+/**
+ * Framed packet, all fields little endian:
+ *
+ *   0xAA 0x55 version length | seq:u16 sender_us:u32 pitch roll yaw:i16 | crc:u16
+ *
+ * length counts the payload only, the CRC-16/CCITT (0x1021, init 0xFFFF)
+ * covers version, length and payload.
+ */
+#define UART_SYNC0              0xAA
+#define UART_SYNC1              0x55
+#define UART_FRAME_VERSION      1
+#define UART_FRAME_HEADER       4
+#define UART_FRAME_PAYLOAD      12
+#define UART_FRAME_SIZE         (UART_FRAME_HEADER + UART_FRAME_PAYLOAD + 2)
+
+typedef enum {
+    UART_PROTOCOL_LEGACY,
+    UART_PROTOCOL_FRAMED,
+} uart_protocol_t;
+
+/**
+ * Link quality, cumulative. Written by the parsing thread only.
+ */
+typedef struct {
+    uint32_t frames;        // accepted
+    uint32_t corrupt;       // bad header or CRC
+    uint32_t dropped;       // gaps in the sequence numbers
+    uint32_t duplicated;    // same sequence number again
+    uint32_t skipped;       // bytes discarded while resynchronizing
+} uart_counters_t;
+
+// Bytes pulled per read(), a few dozen packets at 115200 baud
+#define UART_READ_SIZE      256
+
+typedef struct {
+    uart_protocol_t protocol;
+    int state;
+    int idx;
+    uint8_t buf[UART_FRAME_SIZE];
+
+    int have_seq;
+    uint16_t last_seq;
+
+    uart_counters_t counters;
+} uart_parser_t;
+
+/**
+ * Open a tty at 115200 8N1, raw. read() returns once a full packet's
+ * worth of bytes arrived or the line went quiet for 100 ms, whatever
+ * else is buffered comes along in the same call.
+ */
+int uart_open(const char *path);
+
+void uart_parser_init(uart_parser_t *p, uart_protocol_t protocol);
+
+/**
+ * Feed received bytes, returns the number of packets accepted.
+ * latest receives the newest one, untouched when none was accepted.
+ * The framed parser rescans from the byte after a rejected sync, so a
+ * corrupt or truncated frame costs at most that frame.
+ */
+int uart_parse(uart_parser_t *p, const uint8_t *data, size_t n,
+               attitude_t *latest);
+
+/**
+ * Build a framed packet (sender side, and test senders), returns its
+ * size, UART_FRAME_SIZE
+ */
+size_t uart_frame_encode(uint8_t out[UART_FRAME_SIZE], const attitude_t *a);
+
+uint16_t uart_crc16(const uint8_t *data, size_t n);
+
+#endif
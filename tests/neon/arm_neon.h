@@ -0,0 +1,303 @@
+#ifndef __TEST_ARM_NEON_H
+#define __TEST_ARM_NEON_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * Host stand-in for <arm_neon.h>: the intrinsics draw_navball_neon()
+ * uses, as 4-lane scalar code, so the NEON renderer can be built and
+ * compared on the build machine (tests/texel_dump, make check).
+ *
+ * Lanes behave as on ARMv7 NEON: multiply-accumulate rounds the product
+ * before the add, float to int conversion truncates and saturates, and
+ * vrecpe/vrsqrte return the 8-bit estimates of the ARM ARM
+ * (RecipEstimate, RecipSqrtEstimate) rather than exact results, so the
+ * Newton-Raphson steps after them are exercised as on the board.
+ * Denormals, NaNs and FPSCR modes are not modelled.
+ *
+ * Build with -ffp-contract=off, a fused multiply-add would round
+ * differently than the board.
+ */
+
+typedef float    float32x4_t __attribute__((vector_size(16)));
+typedef int32_t  int32x4_t   __attribute__((vector_size(16)));
+typedef uint32_t uint32x4_t  __attribute__((vector_size(16)));
+
+#define NEON_LANES(expr) \
+    for (int lane = 0; lane < 4; lane++) \
+        r[lane] = (expr)
+
+// Loads, stores, constants, casts
+
+static inline float32x4_t vld1q_f32(const float *p)
+{
+    float32x4_t r;
+    memcpy(&r, p, sizeof(r));
+    return r;
+}
+
+static inline void vst1q_s32(int32_t *p, int32x4_t a)
+{
+    memcpy(p, &a, sizeof(a));
+}
+
+static inline float32x4_t vdupq_n_f32(float n)
+{
+    return (float32x4_t){ n, n, n, n };
+}
+
+static inline int32x4_t vdupq_n_s32(int32_t n)
+{
+    return (int32x4_t){ n, n, n, n };
+}
+
+static inline uint32x4_t vdupq_n_u32(uint32_t n)
+{
+    return (uint32x4_t){ n, n, n, n };
+}
+
+static inline float32x4_t vreinterpretq_f32_u32(uint32x4_t a)
+{
+    float32x4_t r;
+    memcpy(&r, &a, sizeof(r));
+    return r;
+}
+
+static inline uint32x4_t vreinterpretq_u32_f32(float32x4_t a)
+{
+    uint32x4_t r;
+    memcpy(&r, &a, sizeof(r));
+    return r;
+}
+
+// Float arithmetic
+
+static inline float32x4_t vabsq_f32(float32x4_t a)
+{
+    float32x4_t r;
+    NEON_LANES(fabsf(a[lane]));
+    return r;
+}
+
+static inline float32x4_t vnegq_f32(float32x4_t a)
+{
+    return -a;
+}
+
+static inline float32x4_t vmaxq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t r;
+    NEON_LANES(a[lane] > b[lane] ? a[lane] : b[lane]);
+    return r;
+}
+
+static inline float32x4_t vminq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t r;
+    NEON_LANES(a[lane] < b[lane] ? a[lane] : b[lane]);
+    return r;
+}
+
+static inline float32x4_t vsubq_f32(float32x4_t a, float32x4_t b)
+{
+    return a - b;
+}
+
+static inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b)
+{
+    return a * b;
+}
+
+static inline float32x4_t vmulq_n_f32(float32x4_t a, float n)
+{
+    return a * vdupq_n_f32(n);
+}
+
+// a + b * c, the product rounded first (VMLA is not fused)
+static inline float32x4_t vmlaq_f32(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+    float32x4_t p = b * c;
+    return a + p;
+}
+
+static inline float32x4_t vmlaq_n_f32(float32x4_t a, float32x4_t b, float n)
+{
+    return vmlaq_f32(a, b, vdupq_n_f32(n));
+}
+
+static inline float32x4_t vmlsq_f32(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+    float32x4_t p = b * c;
+    return a - p;
+}
+
+// Estimates and their Newton-Raphson steps
+
+// ARM ARM RecipEstimate(), a in [0.5, 1), result in [1, 2) with 8 bits
+static inline double neon_recip_estimate(double a)
+{
+    int q = (int)(a * 512.0);
+    double r = 1.0 / (((double)q + 0.5) / 512.0);
+    int s = (int)(256.0 * r + 0.5);
+    return s / 256.0;
+}
+
+// ARM ARM RecipSqrtEstimate(), a in [0.25, 1), result in [1, 2) with 8 bits
+static inline double neon_rsqrt_estimate(double a)
+{
+    double r;
+    if (a < 0.5) {
+        int q = (int)(a * 512.0);
+        r = 1.0 / sqrt(((double)q + 0.5) / 512.0);
+    } else {
+        int q = (int)(a * 256.0);
+        r = 1.0 / sqrt(((double)q + 0.5) / 256.0);
+    }
+    int s = (int)(256.0 * r + 0.5);
+    return s / 256.0;
+}
+
+static inline float neon_recpe(float x)
+{
+    if (x == 0.0f || !isnormal(x))
+        return copysignf(INFINITY, x);
+
+    int e;
+    double m = frexp(fabs(x), &e);                  // fabs(x) = m * 2^e, m in [0.5, 1)
+    double a = floor(m * 512.0) / 512.0;            // top 8 fraction bits
+
+    return (float)copysign(ldexp(neon_recip_estimate(a), -e), x);
+}
+
+static inline float neon_rsqrte(float x)
+{
+    if (x < 0.0f)
+        return NAN;
+    if (x == 0.0f || !isnormal(x))
+        return INFINITY;
+
+    int e;
+    double m = frexp(x, &e);                        // x = m * 2^e, m in [0.5, 1)
+    double a = floor(m * 512.0) / 512.0;            // top 8 fraction bits
+
+    // odd exponents move a factor 2 into the scaled input, a in [0.25, 0.5)
+    if (e & 1) {
+        a /= 2.0;
+        e++;
+    }
+
+    return (float)ldexp(neon_rsqrt_estimate(a), -e / 2);
+}
+
+static inline float32x4_t vrecpeq_f32(float32x4_t a)
+{
+    float32x4_t r;
+    NEON_LANES(neon_recpe(a[lane]));
+    return r;
+}
+
+static inline float32x4_t vrsqrteq_f32(float32x4_t a)
+{
+    float32x4_t r;
+    NEON_LANES(neon_rsqrte(a[lane]));
+    return r;
+}
+
+// 2 - a * b
+static inline float32x4_t vrecpsq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t p = a * b;
+    return vdupq_n_f32(2.0f) - p;
+}
+
+// (3 - a * b) / 2
+static inline float32x4_t vrsqrtsq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t p = a * b;
+    return (vdupq_n_f32(3.0f) - p) * vdupq_n_f32(0.5f);
+}
+
+// Compares and selects
+
+static inline uint32x4_t vcgtq_f32(float32x4_t a, float32x4_t b)
+{
+    uint32x4_t r;
+    NEON_LANES(a[lane] > b[lane] ? 0xFFFFFFFFu : 0);
+    return r;
+}
+
+static inline uint32x4_t vcltq_f32(float32x4_t a, float32x4_t b)
+{
+    uint32x4_t r;
+    NEON_LANES(a[lane] < b[lane] ? 0xFFFFFFFFu : 0);
+    return r;
+}
+
+static inline float32x4_t vbslq_f32(uint32x4_t mask, float32x4_t a, float32x4_t b)
+{
+    uint32x4_t ua = vreinterpretq_u32_f32(a), ub = vreinterpretq_u32_f32(b);
+    return vreinterpretq_f32_u32((ua & mask) | (ub & ~mask));
+}
+
+static inline uint32x4_t vandq_u32(uint32x4_t a, uint32x4_t b)
+{
+    return a & b;
+}
+
+static inline uint32x4_t vorrq_u32(uint32x4_t a, uint32x4_t b)
+{
+    return a | b;
+}
+
+// Integer
+
+// Truncates towards zero, saturating at the int32 range
+static inline int32x4_t vcvtq_s32_f32(float32x4_t a)
+{
+    int32x4_t r;
+    for (int lane = 0; lane < 4; lane++) {
+        float f = a[lane];
+        r[lane] = f != f ? 0 :
+                  f >= 2147483648.0f ? INT32_MAX :
+                  f <= -2147483648.0f ? INT32_MIN : (int32_t)f;
+    }
+    return r;
+}
+
+static inline int32x4_t vaddq_s32(int32x4_t a, int32x4_t b)
+{
+    return a + b;
+}
+
+static inline int32x4_t vandq_s32(int32x4_t a, int32x4_t b)
+{
+    return a & b;
+}
+
+static inline int32x4_t vmaxq_s32(int32x4_t a, int32x4_t b)
+{
+    int32x4_t r;
+    NEON_LANES(a[lane] > b[lane] ? a[lane] : b[lane]);
+    return r;
+}
+
+static inline int32x4_t vminq_s32(int32x4_t a, int32x4_t b)
+{
+    int32x4_t r;
+    NEON_LANES(a[lane] < b[lane] ? a[lane] : b[lane]);
+    return r;
+}
+
+static inline int32x4_t vmlaq_n_s32(int32x4_t a, int32x4_t b, int32_t n)
+{
+    return a + b * vdupq_n_s32(n);
+}
+
+#define vshlq_n_s32(a, n)   ((a) << (n))
+#define vshrq_n_s32(a, n)   ((a) >> (n))
+
+#undef NEON_LANES
+
+#endif
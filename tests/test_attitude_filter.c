@@ -0,0 +1,72 @@
+#include "attitude_filter.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * Interpolation fraction at large CLOCK_MONOTONIC stamps: with packets
+ * 20 ms apart at around 1e11 us (a board up for a day), sampling in
+ * 1 us steps must move the yaw evenly between the packets, for
+ * INTERPOLATE and for EXTRAPOLATE up to its cut-off.
+ *
+ * Usage: test_attitude_filter
+ */
+
+#define BASE_US         100000000000ull
+#define INTERVAL_US     20000
+#define YAW_STEP        10.0f       // degrees per packet
+#define MAX_ERROR       0.002f      // degrees, 4 us of motion
+
+static int check(attitude_mode_t mode, const char *name,
+                 uint64_t from_us, uint64_t to_us, uint64_t lag_us)
+{
+    attitude_filter_t f;
+    attitude_filter_init(&f, mode);
+
+    for (int i = 0; i < 3; i++) {
+        attitude_t a = {
+            .yaw = (int16_t)(i * YAW_STEP),
+            .rx_us = BASE_US + i * INTERVAL_US,
+        };
+        attitude_filter_push(&f, &a);
+    }
+
+    float worst = 0, last = -1;
+    int steps = 0, backwards = 0;
+
+    for (uint64_t t = from_us; t <= to_us; t++, steps++) {
+        float pitch, roll, yaw;
+        attitude_filter_sample(&f, t + lag_us, &pitch, &roll, &yaw);
+
+        float expect = (float)(int64_t)(t - BASE_US) * (YAW_STEP / INTERVAL_US);
+        float e = fabsf(yaw - expect);
+        if (e > worst)
+            worst = e;
+        if (yaw < last)
+            backwards++;
+        last = yaw;
+    }
+
+    int ok = worst <= MAX_ERROR && !backwards;
+
+    printf("attitude %s at %.0e us: %d steps, max error %.2e deg, %d backwards: %s\n",
+           name, (double)BASE_US, steps, worst, backwards, ok ? "ok" : "FAILED");
+
+    return ok;
+}
+
+int main(void)
+{
+    int ok = 1;
+
+    // sampled one packet interval behind, between the first two packets
+    ok &= check(ATTITUDE_INTERPOLATE, "interpolate",
+                BASE_US, BASE_US + INTERVAL_US, INTERVAL_US);
+
+    // past the newest packet up to the extrapolation limit
+    ok &= check(ATTITUDE_EXTRAPOLATE, "extrapolate",
+                BASE_US + 2 * INTERVAL_US,
+                BASE_US + 2 * INTERVAL_US + ATTITUDE_MAX_EXTRAPOLATE_US, 0);
+
+    return !ok;
+}
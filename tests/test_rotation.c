@@ -0,0 +1,63 @@
+#include "horizon.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * navball_rotation_matrix() against the step by step rotate_vec(): same
+ * table sines, same rotation order, so the rotated points may only
+ * differ by float rounding.
+ *
+ * Usage: test_rotation
+ */
+
+#define ANGLE_SETS      20000
+#define POINTS_PER_SET  16
+#define MAX_ERROR       1e-5f
+
+static uint32_t rng_state = 0x9E3779B9;
+
+// xorshift32, deterministic across hosts
+static float random_unit(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+int main(void)
+{
+    float worst = 0;
+
+    for (int i = 0; i < ANGLE_SETS; i++) {
+        // Past +-PI on purpose, fsin()/fcos() wrap
+        float pitch = random_unit() * (float)(2 * PI);
+        float roll = random_unit() * (float)(2 * PI);
+        float yaw = random_unit() * (float)(2 * PI);
+
+        float m[9];
+        navball_rotation_matrix(m, pitch, roll, yaw);
+
+        for (int j = 0; j < POINTS_PER_SET; j++) {
+            float x = random_unit(), y = random_unit(), z = random_unit();
+
+            float mx = m[0]*x + m[1]*y + m[2]*z;
+            float my = m[3]*x + m[4]*y + m[5]*z;
+            float mz = m[6]*x + m[7]*y + m[8]*z;
+
+            rotate_vec(&x, &y, &z, pitch, roll, yaw);
+
+            float e = fmaxf(fabsf(mx - x), fmaxf(fabsf(my - y), fabsf(mz - z)));
+            if (e > worst)
+                worst = e;
+        }
+    }
+
+    int ok = worst <= MAX_ERROR;
+
+    printf("rotation matrix vs rotate_vec: %d points, max error %.2e: %s\n",
+           ANGLE_SETS * POINTS_PER_SET, worst, ok ? "ok" : "FAILED");
+
+    return !ok;
+}
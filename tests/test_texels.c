@@ -0,0 +1,91 @@
+#include "horizon.h"
+#include "texel_dump.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * Compares two texel_dump outputs pixel by pixel, a renderer variant
+ * against the float build. Both must draw the same disc, and every
+ * pixel must sample within MAX_ERROR texels of the reference.
+ *
+ * The u error is measured along the sphere: one texel of longitude
+ * is cos(latitude) texels wide, so next to the poles, where any u is
+ * as good as another, a large u difference is a small distance.
+ *
+ * Usage: test_texels NAME REFERENCE VARIANT MAX_ERROR
+ */
+
+static uint16_t ref[FB_WIDTH * FB_HEIGHT][2];
+static uint16_t var[FB_WIDTH * FB_HEIGHT][2];
+
+int main(int argc, char **argv)
+{
+    if (argc != 5) {
+        printf("Usage: %s NAME REFERENCE VARIANT MAX_ERROR\n", argv[0]);
+        return 1;
+    }
+
+    const char *name = argv[1];
+    float max_error = atof(argv[4]);
+
+    FILE *fr = fopen(argv[2], "rb");
+    FILE *fv = fopen(argv[3], "rb");
+    if (!fr || !fv) {
+        perror(fr ? argv[3] : argv[2]);
+        return 1;
+    }
+
+    // width of one texel of longitude on each texture row
+    float row_scale[TEXEL_DUMP_H];
+    for (int ty = 0; ty < TEXEL_DUMP_H; ty++)
+        row_scale[ty] = cosf((float)M_PI * ((ty + 0.5f) / TEXEL_DUMP_H - 0.5f));
+
+    long pixels = 0, exact = 0, over = 0;
+    float worst_u = 0;
+    int worst_v = 0;
+
+    for (int frame = 0; frame < TEXEL_DUMP_FRAMES; frame++) {
+        if (fread(ref, sizeof(ref), 1, fr) != 1 || fread(var, sizeof(var), 1, fv) != 1) {
+            printf("%s: short dump at frame %d\n", name, frame);
+            return 1;
+        }
+
+        for (int p = 0; p < FB_WIDTH * FB_HEIGHT; p++) {
+            if (ref[p][0] == TEXEL_NONE && var[p][0] == TEXEL_NONE)
+                continue;
+
+            if (ref[p][0] == TEXEL_NONE || var[p][0] == TEXEL_NONE) {
+                printf("%s: frame %d pixel %d drawn by one build only\n", name, frame, p);
+                return 1;
+            }
+
+            pixels++;
+
+            int du = abs(ref[p][0] - var[p][0]);
+            if (du > TEXEL_DUMP_W - du)
+                du = TEXEL_DUMP_W - du;
+            int dv = abs(ref[p][1] - var[p][1]);
+
+            if (!du && !dv)
+                exact++;
+
+            float arc = du * row_scale[ref[p][1]];
+            if (arc > worst_u)
+                worst_u = arc;
+            if (dv > worst_v)
+                worst_v = dv;
+            if (arc > max_error || dv > max_error)
+                over++;
+        }
+    }
+
+    int ok = over == 0;
+
+    printf("%s: %ld pixels, %.1f%% same texel, max error u %.2f v %d texels: %s\n",
+           name, pixels, 100.0 * exact / pixels, worst_u, worst_v,
+           ok ? "ok" : "FAILED");
+
+    return !ok;
+}
@@ -0,0 +1,91 @@
+#include "navball_uv.h"
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * navball_uv_texel() against the libm reference navball_uv_texel_ref():
+ * at most one texel apart for every direction, at the texture sizes
+ * the renderer has used. U wraps, texel 0 and w - 1 are neighbours.
+ *
+ * Usage: test_uv
+ */
+
+#define GRID_STEPS      1024    // longitude/latitude grid, GRID_STEPS^2 points
+#define RANDOM_SAMPLES  2000000
+
+static const struct { int w, h; } sizes[] = {
+    { 256, 128 },
+    { 160, 80 },
+};
+
+static uint32_t rng_state = 0x2545F491;
+
+// xorshift32, deterministic across hosts
+static float random_unit(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+static int worst_u, worst_v;
+
+static void check(float x, float y, float z, int w, int h)
+{
+    int tx, ty, rx, ry;
+
+    navball_uv_texel(x, y, z, w, h, &tx, &ty);
+    navball_uv_texel_ref(x, y, z, w, h, &rx, &ry);
+
+    int du = tx > rx ? tx - rx : rx - tx;
+    if (du > w - du)
+        du = w - du;
+
+    int dv = ty > ry ? ty - ry : ry - ty;
+
+    if (du > worst_u) worst_u = du;
+    if (dv > worst_v) worst_v = dv;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int w = sizes[s].w, h = sizes[s].h;
+        long samples = 0;
+
+        worst_u = worst_v = 0;
+
+        for (int i = 0; i < GRID_STEPS; i++) {
+            float lat = (float)PI * ((i + 0.5f) / GRID_STEPS - 0.5f);
+
+            for (int j = 0; j < GRID_STEPS; j++) {
+                float lon = (float)(2 * PI) * (j + 0.5f) / GRID_STEPS - (float)PI;
+
+                check(cosf(lat) * cosf(lon), sinf(lat), cosf(lat) * sinf(lon), w, h);
+                samples++;
+            }
+        }
+
+        for (int i = 0; i < RANDOM_SAMPLES; i++) {
+            float x = random_unit(), y = random_unit(), z = random_unit();
+            float n = sqrtf(x*x + y*y + z*z);
+
+            if (n < 1e-3f || n > 1.0f)
+                continue;
+
+            check(x / n, y / n, z / n, w, h);
+            samples++;
+        }
+
+        int ok = worst_u <= 1 && worst_v <= 1;
+        failed |= !ok;
+
+        printf("uv %dx%d: %ld samples, max error u %d v %d texels: %s\n",
+               w, h, samples, worst_u, worst_v, ok ? "ok" : "FAILED");
+    }
+
+    return failed;
+}
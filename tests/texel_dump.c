@@ -0,0 +1,100 @@
+#include "horizon.h"
+#include "texture_layout.h"
+#include "texel_dump.h"
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * Renders a fixed attitude sweep with the renderer this file is built
+ * against (float, FIXED_POINT, NEON; draw_navball_heading() with
+ * TEXEL_DUMP_HEADING) and writes the texel every disc pixel sampled,
+ * for test_texels to compare between builds.
+ *
+ * The texel is read back through the palette: one synthetic texture has
+ * the texel column as its palette index, a second one the row.
+ *
+ * Usage: texel_dump OUT
+ */
+
+#define TEX_W       TEXEL_DUMP_W
+#define TEX_H       TEXEL_DUMP_H
+
+static uint16_t palette[256];
+static uint8_t column_texels[TEX_W * TEX_H];
+static uint8_t row_texels[TEX_W * TEX_H];
+
+static uint16_t tx_frame[FB_WIDTH * FB_HEIGHT];
+static uint16_t ty_frame[FB_WIDTH * FB_HEIGHT];
+static uint16_t pairs[FB_WIDTH * FB_HEIGHT][2];
+
+static void render(const uint8_t *texels, float pitch, float roll, float yaw,
+                   uint16_t *out)
+{
+    texture_t tex = {
+        .width = TEX_W,
+        .height = TEX_H,
+        .palette = palette,
+        .texels = texels,
+    };
+
+    horizon_set_texture(&tex);
+    fb_clear(0);
+#if defined(TEXEL_DUMP_HEADING)
+    draw_navball_heading(pitch, roll, yaw);
+#else
+    draw_navball(pitch, roll, yaw);
+#endif
+
+    const uint16_t *fb = horizon_get_framebuffer();
+    for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++)
+        out[i] = fb[i] ? fb[i] - 1 : TEXEL_NONE;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        printf("Usage: %s OUT\n", argv[0]);
+        return 1;
+    }
+
+    // Palette entry 0 stays free for the background
+    for (int i = 0; i < 256; i++)
+        palette[i] = i + 1;
+
+    for (int y = 0; y < TEX_H; y++) {
+        for (int x = 0; x < TEX_W; x++) {
+            column_texels[texture_index(x, y, TEX_W)] = x;
+            row_texels[texture_index(x, y, TEX_W)] = y;
+        }
+    }
+
+    FILE *f = fopen(argv[1], "wb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    horizon_init();
+
+    for (int i = 0; i < TEXEL_DUMP_FRAMES; i++) {
+        // Pitch sweeps through both poles, roll and yaw all the way round
+        float pitch = -180.0f + i * (360.0f / TEXEL_DUMP_FRAMES) + 0.37f;
+        float roll = i * 47.3f;
+        float yaw = i * 29.9f;
+
+        render(column_texels, pitch, roll, yaw, tx_frame);
+        render(row_texels, pitch, roll, yaw, ty_frame);
+
+        for (int p = 0; p < FB_WIDTH * FB_HEIGHT; p++) {
+            pairs[p][0] = tx_frame[p];
+            pairs[p][1] = ty_frame[p];
+        }
+
+        if (fwrite(pairs, sizeof(pairs), 1, f) != 1) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    return fclose(f) ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+#ifndef __TEXEL_DUMP_H
+#define __TEXEL_DUMP_H
+
+/**
+ * Dump format of texel_dump, read by test_texels: per frame
+ * FB_WIDTH * FB_HEIGHT pairs of u16 (tx, ty) into a TEXEL_DUMP_W x
+ * TEXEL_DUMP_H texture, TEXEL_NONE outside the disc.
+ */
+#define TEXEL_DUMP_W        256
+#define TEXEL_DUMP_H        128
+#define TEXEL_DUMP_FRAMES   120
+#define TEXEL_NONE          0xFFFF
+
+#endif
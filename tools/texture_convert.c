@@ -0,0 +1,303 @@
+#include "texture.h"
+#include "texture_layout.h"
+#include <png.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <getopt.h>
+
+/**
+ * Converts a navball PNG from resources/ into a palette indexed
+ * texture: C source for the built-in texture (navball_texture.h), or
+ * with --format tex a texture file for lcd_app --texture (texture.h).
+ *
+ * The image is box filtered down to --size (integer factors only),
+ * reduced to RGB565, and the 256 most used colours become the palette,
+ * written in panel byte order so the renderer never swaps.
+ * The art is a few flat colours plus anti-aliased edges, any colour
+ * beyond the palette maps to its nearest entry. Texels are written in
+ * the tiled layout of texture_layout.h, or row-major with --linear.
+ */
+
+#define PALETTE_SIZE    256
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [--format c|tex] [--size WxH] [--linear] IN.png OUT\n", prog);
+}
+
+static uint16_t rgb565(int r, int g, int b)
+{
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+static int color_dist(uint16_t a, uint16_t b)
+{
+    int dr = ((a >> 11) & 0x1f) - ((b >> 11) & 0x1f);
+    int dg = ((a >> 5) & 0x3f) - ((b >> 5) & 0x3f);
+    int db = (a & 0x1f) - (b & 0x1f);
+
+    // green has twice the steps of red and blue
+    return 4 * dr * dr + dg * dg + 4 * db * db;
+}
+
+static uint32_t histogram[65536];
+
+static int cmp_by_count(const void *a, const void *b)
+{
+    uint32_t x = histogram[*(const uint16_t*)a];
+    uint32_t y = histogram[*(const uint16_t*)b];
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static int write_c(const char *path, const char *in_path, int w, int h, int linear,
+                   int color_count, int remapped,
+                   const uint16_t *palette, const uint8_t *indices)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+
+    fprintf(f, "// Generated by tools/texture_convert from %s, do not edit\n", in_path);
+    fprintf(f, "#include \"navball_texture.h\"\n\n");
+    fprintf(f, "#if NAVBALL_TEXTURE_WIDTH != %d || NAVBALL_TEXTURE_HEIGHT != %d\n", w, h);
+    fprintf(f, "#error \"texture generated for %dx%d\"\n", w, h);
+    fprintf(f, "#endif\n\n");
+
+    fprintf(f, "// %d colours, %d texels remapped to the nearest entry.\n",
+            color_count, remapped);
+    fprintf(f, "// RGB565 in panel byte order, see FB_COLOR()\n");
+    fprintf(f, "const uint16_t navball_palette[NAVBALL_PALETTE_SIZE] = {\n");
+    for (int i = 0; i < PALETTE_SIZE; i++) {
+        fprintf(f, "%s0x%04x,", i % 16 ? " " : "  ",
+                (uint16_t)(palette[i] << 8 | palette[i] >> 8));
+        if (i % 16 == 15)
+            fprintf(f, "\n");
+    }
+    fprintf(f, "};\n\n");
+
+    if (linear)
+        fprintf(f, "// %dx%d texels, row-major\n", w, h);
+    else
+        fprintf(f, "// %dx%d texels in %dx%d tiles, see texture_layout.h\n",
+                w, h, TEXTURE_TILE, TEXTURE_TILE);
+    fprintf(f, "const uint8_t navball_texture[NAVBALL_TEXTURE_HEIGHT*NAVBALL_TEXTURE_WIDTH] "
+               "__attribute__((aligned(64))) = {\n");
+    for (int i = 0; i < w * h; i++) {
+        fprintf(f, "%s0x%02x,", i % 16 ? " " : "  ", indices[i]);
+        if (i % 16 == 15)
+            fprintf(f, "\n");
+    }
+    fprintf(f, "};\n");
+
+    return fclose(f) ? -1 : 0;
+}
+
+// Header, palette and texels each start on a TEXTURE_DATA_ALIGN boundary
+static int write_tex(const char *path, int w, int h, int linear,
+                     const uint16_t *palette, const uint8_t *indices)
+{
+    static const uint8_t pad[TEXTURE_DATA_ALIGN];
+    uint8_t panel[PALETTE_SIZE * 2];
+
+    // Big endian bytes: in memory the entries are panel order as they are
+    for (int i = 0; i < PALETTE_SIZE; i++) {
+        panel[2 * i] = palette[i] >> 8;
+        panel[2 * i + 1] = palette[i] & 0xFF;
+    }
+
+    texture_file_header_t hdr = {
+        .magic = TEXTURE_MAGIC,
+        .width = w,
+        .height = h,
+        .format = TEXTURE_FORMAT_I8,
+        .layout = linear ? TEXTURE_LAYOUT_LINEAR : TEXTURE_LAYOUT_TILED,
+        .palette_size = PALETTE_SIZE,
+        .palette_offset = TEXTURE_DATA_ALIGN,
+        .texel_offset = TEXTURE_DATA_ALIGN + PALETTE_SIZE * 2,
+    };
+
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return -1;
+
+    int ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+             fwrite(pad, TEXTURE_DATA_ALIGN - sizeof(hdr), 1, f) == 1 &&
+             fwrite(panel, sizeof(panel), 1, f) == 1 &&
+             fwrite(indices, 1, w * h, f) == (size_t)(w * h);
+
+    if (fclose(f) || !ok)
+        return -1;
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        { "format", required_argument, NULL, 'f' },
+        { "size",   required_argument, NULL, 's' },
+        { "linear", no_argument,       NULL, 'l' },
+        { "help",   no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int w = 0, h = 0;
+    int linear = 0;
+    int tex_format = 0;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:s:lh", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'f':
+            if (!strcmp(optarg, "tex")) {
+                tex_format = 1;
+            } else if (!strcmp(optarg, "c")) {
+                tex_format = 0;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 's':
+            if (sscanf(optarg, "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'l':
+            linear = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind + 2 != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *in_path = argv[optind];
+    const char *out_path = argv[optind + 1];
+
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_file(&image, in_path)) {
+        printf("%s: %s\n", in_path, image.message);
+        return 1;
+    }
+
+    image.format = PNG_FORMAT_RGB;
+    int src_w = image.width, src_h = image.height;
+    uint8_t *rgb = malloc(PNG_IMAGE_SIZE(image));
+
+    if (!rgb || !png_image_finish_read(&image, NULL, rgb, 0, NULL)) {
+        printf("%s: %s\n", in_path, rgb ? image.message : "out of memory");
+        return 1;
+    }
+
+    if (!w) {
+        w = src_w;
+        h = src_h;
+    }
+
+    if (src_w % w || src_h % h) {
+        printf("%s: %dx%d is not an integer multiple of %dx%d\n",
+               in_path, src_w, src_h, w, h);
+        return 1;
+    }
+
+    if (tex_format && (w > TEXTURE_MAX_WIDTH || h > TEXTURE_MAX_HEIGHT)) {
+        printf("%dx%d is larger than %dx%d\n",
+               w, h, TEXTURE_MAX_WIDTH, TEXTURE_MAX_HEIGHT);
+        return 1;
+    }
+
+    if (!linear && (w % TEXTURE_TILE || h % TEXTURE_TILE)) {
+        printf("%dx%d is not a multiple of the %d texel tile\n",
+               w, h, TEXTURE_TILE);
+        return 1;
+    }
+
+    // Box filter down to w x h, then RGB565
+    int fx = src_w / w, fy = src_h / h;
+    uint16_t *texels = malloc(w * h * sizeof(uint16_t));
+    if (!texels)
+        return 1;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int sum[3] = { 0, 0, 0 };
+
+            for (int sy = 0; sy < fy; sy++)
+                for (int sx = 0; sx < fx; sx++)
+                    for (int c = 0; c < 3; c++)
+                        sum[c] += rgb[((y * fy + sy) * src_w + x * fx + sx) * 3 + c];
+
+            int n = fx * fy;
+            texels[y * w + x] = rgb565(sum[0] / n, sum[1] / n, sum[2] / n);
+            histogram[texels[y * w + x]]++;
+        }
+    }
+
+    // Palette: the most used colours
+    static uint16_t colors[65536];
+    int color_count = 0;
+
+    for (int c = 0; c < 65536; c++)
+        if (histogram[c])
+            colors[color_count++] = c;
+
+    qsort(colors, color_count, sizeof(colors[0]), cmp_by_count);
+
+    static uint8_t index_of[65536];
+    uint16_t palette[PALETTE_SIZE] = { 0 };
+    int used = color_count < PALETTE_SIZE ? color_count : PALETTE_SIZE;
+
+    for (int i = 0; i < used; i++) {
+        palette[i] = colors[i];
+        index_of[colors[i]] = i;
+    }
+
+    int remapped = 0;
+    for (int i = used; i < color_count; i++) {
+        int best = 0;
+        for (int p = 1; p < used; p++)
+            if (color_dist(colors[i], palette[p]) < color_dist(colors[i], palette[best]))
+                best = p;
+
+        index_of[colors[i]] = best;
+        remapped += histogram[colors[i]];
+    }
+
+    uint8_t *indices = malloc(w * h);
+    if (!indices)
+        return 1;
+
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            indices[linear ? y * w + x : texture_index(x, y, w)] = index_of[texels[y * w + x]];
+
+    int failed = tex_format ?
+        write_tex(out_path, w, h, linear, palette, indices) :
+        write_c(out_path, in_path, w, h, linear, color_count, remapped, palette, indices);
+
+    if (failed) {
+        perror(out_path);
+        return 1;
+    }
+
+    printf("%s: %dx%d %s, %d colours, %d of %d texels remapped\n",
+           out_path, w, h, linear ? "row-major" : "tiled",
+           color_count, remapped, w * h);
+
+    free(indices);
+    free(texels);
+    free(rgb);
+    return 0;
+}